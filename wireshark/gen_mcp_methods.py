@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Generate MCP method lookup tables from mcp_methods.txt.
+
+Emits mcp_methods.h (a collision-free FNV-1a hash table consumed by
+mcp_dissector.c) and rewrites the generated method tables in
+mcp_dissector.lua, so both dissectors stay in sync with one manifest.
+
+Usage: python3 gen_mcp_methods.py  (run from the wireshark/ directory)
+"""
+
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+MANIFEST = os.path.join(HERE, "mcp_methods.txt")
+HEADER = os.path.join(HERE, "mcp_methods.h")
+LUA = os.path.join(HERE, "mcp_dissector.lua")
+
+FNV_PRIME = 0x01000193
+MASK32 = 0xFFFFFFFF
+
+
+def fnv1a(s, seed):
+    h = seed
+    for c in s.encode("ascii"):
+        h = ((h ^ c) * FNV_PRIME) & MASK32
+    return h
+
+
+def read_manifest():
+    entries = []
+    with open(MANIFEST) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.rstrip("\n")
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split("\t")
+            if len(parts) != 3:
+                sys.exit("%s:%d: expected kind<TAB>method<TAB>description" % (MANIFEST, lineno))
+            entries.append(tuple(parts))
+    methods = [m for _, m, _ in entries]
+    if len(set(methods)) != len(methods):
+        sys.exit("duplicate method in manifest")
+    return entries
+
+
+def find_perfect_hash(methods):
+    """Smallest power-of-two table and FNV seed mapping every method to a
+    distinct slot, so lookup is one hash plus one strcmp."""
+    size = 1
+    while size < 2 * len(methods):
+        size *= 2
+    while size <= 4096:
+        for seed in range(1, 100000):
+            slots = set(fnv1a(m, seed) & (size - 1) for m in methods)
+            if len(slots) == len(methods):
+                return size, seed
+        size *= 2
+    sys.exit("no perfect hash found; raise the size/seed search bounds")
+
+
+def c_str(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def write_header(entries, size, seed):
+    table = [None] * size
+    for kind, method, desc in entries:
+        table[fnv1a(method, seed) & (size - 1)] = (method, desc)
+    with open(HEADER, "w") as f:
+        f.write("/* Generated by gen_mcp_methods.py from mcp_methods.txt — do not edit.\n")
+        f.write(" * Collision-free FNV-1a hash table over all MCP methods, tools and\n")
+        f.write(" * resources: lookup is one hash and at most one strcmp. */\n\n")
+        f.write("#define MCP_METHOD_HASH_SIZE %d\n" % size)
+        f.write("#define MCP_METHOD_HASH_SEED 0x%08xu\n\n" % seed)
+        f.write("static const mcp_method_t mcp_method_table[MCP_METHOD_HASH_SIZE] = {\n")
+        for i, entry in enumerate(table):
+            if entry:
+                f.write("    [%d] = {%s, %s},\n" % (i, c_str(entry[0]), c_str(entry[1])))
+        f.write("};\n")
+
+
+def lua_block(entries):
+    out = ["-- BEGIN GENERATED METHOD TABLES (gen_mcp_methods.py, edit mcp_methods.txt)"]
+    for var, kind, title in (("MCP_METHODS", "core", "MCP method constants"),
+                             ("CHESS_TOOLS", "tool", "Chess-specific tools"),
+                             ("CHESS_RESOURCES", "resource", "Chess resources")):
+        out.append("-- " + title)
+        out.append("local %s = {" % var)
+        rows = [(m, d) for k, m, d in entries if k == kind]
+        for i, (m, d) in enumerate(rows):
+            comma = "," if i < len(rows) - 1 else ""
+            out.append('    ["%s"] = "%s"%s' % (m, d, comma))
+        out.append("}")
+        out.append("")
+    out[-1] = "-- END GENERATED METHOD TABLES"
+    return "\n".join(out)
+
+
+def rewrite_lua(entries):
+    with open(LUA) as f:
+        text = f.read()
+    begin = text.index("-- BEGIN GENERATED METHOD TABLES")
+    end = text.index("-- END GENERATED METHOD TABLES")
+    end = text.index("\n", end)
+    text = text[:begin] + lua_block(entries) + text[end:]
+    with open(LUA, "w") as f:
+        f.write(text)
+
+
+def main():
+    entries = read_manifest()
+    size, seed = find_perfect_hash([m for _, m, _ in entries])
+    write_header(entries, size, seed)
+    rewrite_lua(entries)
+    print("mcp_methods.h: %d entries, table size %d, seed 0x%08x" % (len(entries), size, seed))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,266 @@
+/*
+ * mcp_bench: throughput benchmark and fuzz entry point for the MCP parse
+ * core (mcp_core.c).
+ *
+ * Benchmark mode (default build) generates a corpus per message category —
+ * small requests, large training notifications, encrypted envelopes, and
+ * masked/fragmented WebSocket frames — and reports ns/message and
+ * messages/sec for each, so parser changes get measured before they reach
+ * the capture boxes.
+ *
+ * Fuzz mode: built with -DMCP_BENCH_FUZZER and -fsanitize=fuzzer the same
+ * file becomes a libFuzzer target that drives both the frame-header walk
+ * and mcp_parse_json_rpc with arbitrary bytes (see the mcp_fuzz target in
+ * CMakeLists.txt).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "mcp_core.h"
+
+/* ---------------- shared frame walk ---------------- */
+
+/* Walk WebSocket frames in a buffer, unmasking and reassembling like
+ * mcpgrep does, invoking the parser on each complete text message.
+ * Returns the number of messages parsed. */
+static unsigned walk_and_parse(uint8_t *buf, size_t len, unsigned wanted) {
+    size_t off = 0;
+    unsigned parsed = 0;
+    static uint8_t frag[1 << 16];
+    size_t frag_len = 0;
+    int frag_active = 0;
+
+    while (off < len) {
+        mcp_ws_hdr_t hdr;
+        int rc = mcp_ws_parse_header(buf + off, len - off, &hdr);
+        uint8_t *payload;
+        uint64_t plen;
+        mcp_json_data_t d;
+
+        if (rc == MCP_WS_HDR_MORE) break;
+        if (rc == MCP_WS_HDR_MALFORMED) {
+            off++;
+            continue;
+        }
+        plen = hdr.payload_len;
+        if (plen > len - off - hdr.header_len) break;
+        payload = buf + off + hdr.header_len;
+        if (hdr.masked) {
+            mcp_ws_unmask(payload, (size_t)plen, hdr.mask_key);
+        }
+
+        if (hdr.opcode == 1 && hdr.fin && !frag_active) {
+            memset(&d, 0, sizeof(d));
+            mcp_parse_json_rpc((const char *)payload, (size_t)plen, &d, wanted);
+            parsed++;
+        } else if (hdr.opcode == 1 || (hdr.opcode == 0 && frag_active)) {
+            if (hdr.opcode == 1) frag_len = 0;
+            frag_active = 1;
+            if (plen <= sizeof(frag) - frag_len) {
+                memcpy(frag + frag_len, payload, (size_t)plen);
+                frag_len += (size_t)plen;
+            }
+            if (hdr.fin) {
+                memset(&d, 0, sizeof(d));
+                mcp_parse_json_rpc((const char *)frag, frag_len, &d, wanted);
+                parsed++;
+                frag_active = 0;
+            }
+        }
+        off += hdr.header_len + (size_t)plen;
+    }
+    return parsed;
+}
+
+#ifdef MCP_BENCH_FUZZER
+
+/* libFuzzer entry: first byte selects the path under test, the rest is the
+ * input. Both paths must tolerate arbitrary bytes without reading out of
+ * bounds — the parser's only contract. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static uint8_t buf[1 << 16];
+    mcp_json_data_t d;
+
+    if (size < 1 || size - 1 > sizeof(buf)) return 0;
+    mcp_scan_select_impl();
+
+    if (data[0] & 1) {
+        memset(&d, 0, sizeof(d));
+        mcp_parse_json_rpc((const char *)data + 1, size - 1, &d, MCP_WANT_ALL);
+    } else {
+        /* The walk unmasks in place, so fuzz from a writable copy */
+        memcpy(buf, data + 1, size - 1);
+        walk_and_parse(buf, size - 1, MCP_WANT_SUMMARY);
+    }
+    return 0;
+}
+
+#else /* benchmark build */
+
+/* ---------------- corpus generation ---------------- */
+
+static uint32_t rng_state = 0x6d637042; /* "McpB" */
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static size_t gen_small_request(char *out, size_t cap) {
+    static const char *methods[] = {
+        "initialize", "tools/call", "tools/list", "resources/read",
+        "make_chess_move", "get_board_state", "get_legal_moves",
+    };
+    return (size_t)snprintf(out, cap,
+        "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"id\":\"%u\","
+        "\"params\":{\"agentId\":\"agent-%u\",\"name\":\"make_chess_move\","
+        "\"arguments\":{\"move\":\"e2e4\"}}}",
+        methods[rng() % 7], rng() % 100000, rng() % 16);
+}
+
+/* Training notifications run large: a params object padded with the board
+ * tensors the Java side ships during self-play */
+static size_t gen_training_notification(char *out, size_t cap) {
+    size_t n = (size_t)snprintf(out, cap,
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/chess/training_progress\","
+        "\"params\":{\"epoch\":%u,\"loss\":0.%04u,\"boards\":\"", rng() % 500, rng() % 10000);
+    size_t pad = 8192 + rng() % 8192;
+    while (pad-- && n < cap - 4) {
+        out[n++] = (char)('A' + (rng() % 26));
+    }
+    n += (size_t)snprintf(out + n, cap - n, "\"}}");
+    return n;
+}
+
+static size_t gen_encrypted_envelope(char *out, size_t cap) {
+    size_t n = (size_t)snprintf(out, cap,
+        "{\"jsonrpc\":\"2.0\",\"method\":\"tools/call\",\"id\":\"%u\","
+        "\"params\":{\"encrypted\":true,\"iv\":\"AAAAAAAAAAAAAAAA\","
+        "\"ratchetHeader\":\"BBBBBBBBBBBBBBBBBBBBBBBB\",\"ciphertext\":\"",
+        rng() % 100000);
+    size_t pad = 256 + rng() % 1024;
+    while (pad-- && n < cap - 4) {
+        out[n++] = (char)('a' + (rng() % 26));
+    }
+    n += (size_t)snprintf(out + n, cap - n, "\"}}");
+    return n;
+}
+
+/* Wrap a payload in WebSocket framing; optionally masked, optionally split
+ * into a text frame plus continuations */
+static size_t ws_wrap(uint8_t *out, const uint8_t *payload, size_t len,
+                      int masked, int fragments) {
+    size_t n = 0, off = 0;
+    int frag;
+
+    for (frag = 0; frag < fragments; frag++) {
+        size_t chunk = (frag == fragments - 1) ? len - off
+                                               : len / (size_t)fragments;
+        int fin = (frag == fragments - 1);
+        int opcode = (frag == 0) ? 1 : 0;
+        uint8_t key[4];
+        size_t i;
+
+        out[n++] = (uint8_t)((fin ? 0x80 : 0) | opcode);
+        if (chunk < 126) {
+            out[n++] = (uint8_t)((masked ? 0x80 : 0) | chunk);
+        } else if (chunk < 65536) {
+            out[n++] = (uint8_t)((masked ? 0x80 : 0) | 126);
+            out[n++] = (uint8_t)(chunk >> 8);
+            out[n++] = (uint8_t)chunk;
+        } else {
+            return 0;
+        }
+        if (masked) {
+            for (i = 0; i < 4; i++) {
+                key[i] = (uint8_t)rng();
+                out[n++] = key[i];
+            }
+            for (i = 0; i < chunk; i++) {
+                out[n + i] = payload[off + i] ^ key[i & 3];
+            }
+        } else {
+            memcpy(out + n, payload + off, chunk);
+        }
+        n += chunk;
+        off += chunk;
+    }
+    return n;
+}
+
+/* ---------------- measurement ---------------- */
+
+typedef size_t (*gen_fn)(char *, size_t);
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define CORPUS_MSGS 256
+
+static void bench_category(const char *name, gen_fn gen, int masked,
+                           int fragments, unsigned iterations) {
+    static char msg[1 << 15];
+    static uint8_t corpus[CORPUS_MSGS][1 << 15];
+    static uint8_t work[1 << 15];
+    size_t sizes[CORPUS_MSGS];
+    size_t total_bytes = 0;
+    unsigned i, iter, parsed = 0;
+    uint64_t t0, t1, n_msgs;
+    double ns_per, per_sec;
+
+    for (i = 0; i < CORPUS_MSGS; i++) {
+        size_t mlen = gen(msg, sizeof(msg));
+        sizes[i] = ws_wrap(corpus[i], (const uint8_t *)msg, mlen, masked, fragments);
+        total_bytes += sizes[i];
+    }
+
+    t0 = now_ns();
+    for (iter = 0; iter < iterations; iter++) {
+        for (i = 0; i < CORPUS_MSGS; i++) {
+            /* Unmasking mutates the buffer, so each pass works on a copy;
+             * the memcpy is charged to the masked categories evenly */
+            memcpy(work, corpus[i], sizes[i]);
+            parsed += walk_and_parse(work, sizes[i], MCP_WANT_SUMMARY);
+        }
+    }
+    t1 = now_ns();
+
+    n_msgs = (uint64_t)iterations * CORPUS_MSGS;
+    ns_per = (double)(t1 - t0) / (double)n_msgs;
+    per_sec = 1e9 / ns_per;
+    printf("%-28s %8.0f ns/msg %12.0f msg/s %8.1f MB/s  (%u parsed)\n",
+           name, ns_per, per_sec,
+           (double)total_bytes * iterations / ((double)(t1 - t0) / 1e9) / 1e6,
+           parsed);
+    if (parsed != n_msgs) {
+        fprintf(stderr, "mcp_bench: %s: parsed %u of %llu messages\n",
+                name, parsed, (unsigned long long)n_msgs);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = (argc > 1) ? (unsigned)atoi(argv[1]) : 2000;
+
+    mcp_scan_select_impl();
+    printf("mcp_bench: %u iterations x %u messages per category\n\n",
+           iterations, CORPUS_MSGS);
+
+    bench_category("small request", gen_small_request, 0, 1, iterations);
+    bench_category("small request, masked", gen_small_request, 1, 1, iterations);
+    bench_category("training notification", gen_training_notification, 0, 1, iterations / 8 + 1);
+    bench_category("encrypted envelope", gen_encrypted_envelope, 0, 1, iterations);
+    bench_category("masked + 4 fragments", gen_small_request, 1, 4, iterations);
+    return 0;
+}
+
+#endif /* MCP_BENCH_FUZZER */
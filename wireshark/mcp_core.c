@@ -0,0 +1,500 @@
+/*
+ * MCP parse core implementation. See mcp_core.h for the API; the Wireshark
+ * plugin (mcp_dissector.c) layers tvb handling, wmem allocation and display
+ * on top of this, the standalone tools use it directly.
+ */
+
+#include <string.h>
+
+#include "mcp_core.h"
+
+/* x86-64 only: SSE2 is part of the baseline there, so the SSE2 scanner can
+ * be installed without a target attribute or CPU probe. 32-bit x86 has no
+ * such guarantee (pre-SSE2 CPUs exist and compilers may reject the
+ * intrinsics without -msse2), so it takes the scalar path. */
+#if defined(__x86_64__) || defined(_M_X64)
+#define MCP_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/* Structural character scanning.
+ *
+ * The tokenizer's inner loops spend nearly all their time looking for the
+ * next structural byte: a quote, a backslash, or a brace/bracket. On x86-64
+ * we vectorize that search (32 bytes per iteration with AVX2, 16 with SSE2,
+ * selected once at runtime) and fall back to a scalar loop elsewhere. The
+ * scanner only locates candidates; all state (in-string, depth) stays in the
+ * tokenizer, so every implementation must return the same positions. */
+
+static int mcp_is_structural[256];
+
+static void mcp_scan_init_table(void) {
+    memset(mcp_is_structural, 0, sizeof(mcp_is_structural));
+    mcp_is_structural[(unsigned char)'"'] = 1;
+    mcp_is_structural[(unsigned char)'\\'] = 1;
+    mcp_is_structural[(unsigned char)'{'] = 1;
+    mcp_is_structural[(unsigned char)'}'] = 1;
+    mcp_is_structural[(unsigned char)'['] = 1;
+    mcp_is_structural[(unsigned char)']'] = 1;
+}
+
+/* Scalar fallback: table-driven byte walk */
+static size_t mcp_scan_structural_scalar(const char *s, size_t len, size_t i) {
+    while (i < len && !mcp_is_structural[(unsigned char)s[i]]) {
+        i++;
+    }
+    return i;
+}
+
+#ifdef MCP_HAVE_X86_SIMD
+
+static size_t mcp_scan_structural_sse2(const char *s, size_t len, size_t i) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i lbrace = _mm_set1_epi8('{');
+    const __m128i rbrace = _mm_set1_epi8('}');
+    const __m128i lbrack = _mm_set1_epi8('[');
+    const __m128i rbrack = _mm_set1_epi8(']');
+
+    while (i + 16 <= len) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, bslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, lbrace), _mm_cmpeq_epi8(chunk, rbrace))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, lbrack), _mm_cmpeq_epi8(chunk, rbrack)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 16;
+    }
+    return mcp_scan_structural_scalar(s, len, i);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx2")))
+static size_t mcp_scan_structural_avx2(const char *s, size_t len, size_t i) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i lbrace = _mm256_set1_epi8('{');
+    const __m256i rbrace = _mm256_set1_epi8('}');
+    const __m256i lbrack = _mm256_set1_epi8('[');
+    const __m256i rbrack = _mm256_set1_epi8(']');
+
+    while (i + 32 <= len) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, bslash)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lbrace), _mm256_cmpeq_epi8(chunk, rbrace))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lbrack), _mm256_cmpeq_epi8(chunk, rbrack)));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+    return mcp_scan_structural_sse2(s, len, i);
+}
+#endif /* __GNUC__ || __clang__ */
+
+#endif /* MCP_HAVE_X86_SIMD */
+
+typedef size_t (*mcp_scan_fn)(const char *s, size_t len, size_t i);
+static mcp_scan_fn mcp_scan_structural = mcp_scan_structural_scalar;
+
+/* Pick the widest scanner the CPU supports. SSE2 is baseline on x86-64,
+ * AVX2 is probed. */
+void mcp_scan_select_impl(void) {
+    mcp_scan_init_table();
+    mcp_scan_structural = mcp_scan_structural_scalar;
+#ifdef MCP_HAVE_X86_SIMD
+    mcp_scan_structural = mcp_scan_structural_sse2;
+#if defined(__GNUC__) || defined(__clang__)
+    if (__builtin_cpu_supports("avx2")) {
+        mcp_scan_structural = mcp_scan_structural_avx2;
+    }
+#endif
+#endif
+}
+
+/* JSON parsing helper functions.
+ *
+ * The parser is a single-pass tokenizer: it walks the payload exactly once,
+ * recording the span (start pointer + length) of each top-level key/value
+ * pair, and fills mcp_json_data_t from those spans afterwards. String scanning
+ * is escape-aware, so values containing \" do not terminate early. */
+
+/* Advance past a JSON string. 'i' indexes the opening quote; the returned
+ * index is one past the closing quote, with the unquoted content recorded in
+ * 'content'. Returns 'len' if the string is unterminated. */
+static size_t json_skip_string(const char *s, size_t len, size_t i, mcp_span_t *content) {
+    size_t start;
+
+    i++; /* Skip opening quote */
+    start = i;
+    while (i < len) {
+        i = mcp_scan_structural(s, len, i);
+        if (i >= len) break;
+        if (s[i] == '\\') {
+            i += 2; /* Escaped character, including \" */
+            continue;
+        }
+        if (s[i] == '"') {
+            if (content) {
+                content->start = s + start;
+                content->len = i - start;
+            }
+            return i + 1;
+        }
+        i++; /* Brace or bracket inside the string: not structural here */
+    }
+    return len;
+}
+
+/* Advance past one JSON value of any type (string, object, array, number,
+ * literal), recording its full span including delimiters. Objects and arrays
+ * are walked with a depth counter, skipping over embedded strings so braces
+ * inside string values are not miscounted. */
+static size_t json_skip_value(const char *s, size_t len, size_t i, mcp_span_t *span) {
+    size_t start = i;
+    int depth;
+    char open, close;
+
+    if (i >= len) return len;
+
+    if (s[i] == '"') {
+        i = json_skip_string(s, len, i, NULL);
+    } else if (s[i] == '{' || s[i] == '[') {
+        open = s[i];
+        close = (open == '{') ? '}' : ']';
+        depth = 0;
+        while (i < len) {
+            if (s[i] == '"') {
+                i = json_skip_string(s, len, i, NULL);
+            } else if (s[i] == open) {
+                depth++;
+                i++;
+            } else if (s[i] == close) {
+                depth--;
+                i++;
+                if (depth == 0) break;
+            } else {
+                i++;
+            }
+            i = mcp_scan_structural(s, len, i);
+        }
+    } else {
+        /* Number, true, false, null */
+        while (i < len && s[i] != ',' && s[i] != '}' && s[i] != ']' &&
+               s[i] != ' ' && s[i] != '\t' && s[i] != '\r' && s[i] != '\n') {
+            i++;
+        }
+    }
+
+    if (span) {
+        span->start = s + start;
+        span->len = i - start;
+    }
+    return i;
+}
+
+static int span_key_equals(const mcp_span_t *key, const char *name) {
+    size_t name_len = strlen(name);
+    return key->len == name_len && memcmp(key->start, name, name_len) == 0;
+}
+
+/* Parse a signed decimal integer from a span. Tokenizer spans are windows
+ * into the raw payload with no NUL terminator, so strtol() and friends must
+ * never be pointed at them: a payload that ends mid-number would be read past
+ * its end. Stops at the first non-digit; overflow is not a concern for the
+ * small error codes this is used on. */
+static long span_to_long(const mcp_span_t *span) {
+    const char *p = span->start;
+    const char *end = p + span->len;
+    long v = 0;
+    int neg = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    return neg ? -v : v;
+}
+
+/* Walk the members of one JSON object (span includes the braces), invoking
+ * the same key dispatch used at the top level. Used for the nested "error"
+ * object so "code"/"message" are only matched in error context instead of
+ * anywhere in the payload. */
+static void parse_error_object(const mcp_span_t *obj, mcp_json_data_t *data) {
+    const char *s = obj->start;
+    size_t len = obj->len;
+    size_t i = 0;
+    mcp_span_t key, value;
+
+    while (i < len && s[i] != '{') i++;
+    if (i < len) i++; /* Skip '{' */
+
+    while (i < len) {
+        while (i < len && s[i] != '"' && s[i] != '}') i++;
+        if (i >= len || s[i] == '}') break;
+
+        i = json_skip_string(s, len, i, &key);
+        while (i < len && s[i] != ':') i++;
+        if (i >= len) break;
+        i++; /* Skip ':' */
+        while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+        if (i >= len) break;
+
+        if (s[i] == '"') {
+            i = json_skip_string(s, len, i, &value);
+            if (span_key_equals(&key, "message")) {
+                data->error_message = value;
+            }
+        } else {
+            i = json_skip_value(s, len, i, &value);
+            if (span_key_equals(&key, "code")) {
+                data->error_code = (int)span_to_long(&value);
+                data->error_code_span = value;
+            }
+        }
+
+        while (i < len && s[i] != ',' && s[i] != '}') i++;
+        if (i < len && s[i] == ',') i++;
+    }
+}
+
+void mcp_parse_json_rpc(const char *buf, size_t len, mcp_json_data_t *data,
+                        unsigned wanted) {
+    const char *s = buf;
+    size_t i = 0;
+    unsigned found = 0;
+    mcp_span_t key, value;
+
+    /* Find the opening brace of the JSON-RPC envelope */
+    while (i < len && s[i] != '{') i++;
+    if (i >= len) return;
+    i++; /* Skip '{' */
+
+    /* Single pass over the top-level members. Members nobody asked for are
+     * skipped (span walk only, no allocation); once every wanted field was
+     * seen the walk stops early. */
+    while (i < len && (found & wanted) != wanted) {
+        while (i < len && s[i] != '"' && s[i] != '}') i++;
+        if (i >= len || s[i] == '}') break;
+
+        i = json_skip_string(s, len, i, &key);
+        while (i < len && s[i] != ':') i++;
+        if (i >= len) break;
+        i++; /* Skip ':' */
+        while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+        if (i >= len) break;
+
+        if (s[i] == '"') {
+            i = json_skip_string(s, len, i, &value);
+            if (span_key_equals(&key, "jsonrpc")) {
+                if (wanted & MCP_WANT_JSONRPC) data->jsonrpc = value;
+                found |= MCP_WANT_JSONRPC;
+            } else if (span_key_equals(&key, "method")) {
+                if (wanted & MCP_WANT_METHOD) data->method = value;
+                found |= MCP_WANT_METHOD;
+            } else if (span_key_equals(&key, "id")) {
+                if (wanted & MCP_WANT_ID) data->id = value;
+                found |= MCP_WANT_ID;
+            } else if (span_key_equals(&key, "ciphertext")) {
+                if (wanted & MCP_WANT_ENCRYPTION) data->ciphertext = value;
+            } else if (span_key_equals(&key, "iv")) {
+                if (wanted & MCP_WANT_ENCRYPTION) data->iv = value;
+            }
+        } else {
+            i = json_skip_value(s, len, i, &value);
+            if (span_key_equals(&key, "id")) {
+                /* Numeric ID */
+                if (wanted & MCP_WANT_ID) data->id = value;
+                found |= MCP_WANT_ID;
+            } else if (span_key_equals(&key, "encrypted")) {
+                data->encrypted = (value.len == 4 && memcmp(value.start, "true", 4) == 0);
+                found |= MCP_WANT_ENCRYPTION;
+            } else if (span_key_equals(&key, "ratchet_header")) {
+                if (wanted & MCP_WANT_ENCRYPTION) data->ratchet_header = value;
+            } else if (span_key_equals(&key, "params")) {
+                if (wanted & (MCP_WANT_PARAMS | MCP_WANT_AGENT_ID)) data->params = value;
+                found |= MCP_WANT_PARAMS | MCP_WANT_AGENT_ID;
+            } else if (span_key_equals(&key, "result")) {
+                if (wanted & MCP_WANT_RESULT) data->result = value;
+                found |= MCP_WANT_RESULT;
+            } else if (span_key_equals(&key, "error")) {
+                if (wanted & MCP_WANT_ERROR) parse_error_object(&value, data);
+                found |= MCP_WANT_ERROR;
+            }
+        }
+
+        while (i < len && s[i] != ',' && s[i] != '}') i++;
+        if (i < len && s[i] == ',') i++;
+    }
+
+    /* Try to extract agent ID from params */
+    if (data->params.len > 0 && (wanted & MCP_WANT_AGENT_ID)) {
+        mcp_find_agent_id(&data->params, &data->agent_id, 0);
+    }
+}
+
+int mcp_find_member_string(const mcp_span_t *obj, const char *name, mcp_span_t *out) {
+    const char *s = obj->start;
+    size_t len = obj->len;
+    size_t i = 0;
+    mcp_span_t key, value;
+
+    while (i < len && s[i] != '{') i++;
+    if (i < len) i++; /* Skip '{' */
+
+    while (i < len) {
+        while (i < len && s[i] != '"' && s[i] != '}') i++;
+        if (i >= len || s[i] == '}') break;
+
+        i = json_skip_string(s, len, i, &key);
+        while (i < len && s[i] != ':') i++;
+        if (i >= len) break;
+        i++; /* Skip ':' */
+        while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+        if (i >= len) break;
+
+        if (s[i] == '"') {
+            i = json_skip_string(s, len, i, &value);
+            if (span_key_equals(&key, name)) {
+                *out = value;
+                return 1;
+            }
+        } else {
+            i = json_skip_value(s, len, i, &value);
+        }
+
+        while (i < len && s[i] != ',' && s[i] != '}') i++;
+        if (i < len && s[i] == ',') i++;
+    }
+    return 0;
+}
+
+int mcp_find_agent_id(const mcp_span_t *obj, mcp_span_t *out, int depth) {
+    const char *s = obj->start;
+    size_t len = obj->len;
+    size_t i = 0;
+    mcp_span_t key, value;
+
+    if (depth > 4) return 0;
+
+    while (i < len && s[i] != '{') i++;
+    if (i < len) i++; /* Skip '{' */
+
+    while (i < len) {
+        while (i < len && s[i] != '"' && s[i] != '}') i++;
+        if (i >= len || s[i] == '}') break;
+
+        i = json_skip_string(s, len, i, &key);
+        while (i < len && s[i] != ':') i++;
+        if (i >= len) break;
+        i++; /* Skip ':' */
+        while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+        if (i >= len) break;
+
+        if (s[i] == '"') {
+            i = json_skip_string(s, len, i, &value);
+            if (span_key_equals(&key, "agentId") || span_key_equals(&key, "agent_id")) {
+                *out = value;
+                return 1;
+            }
+        } else {
+            i = json_skip_value(s, len, i, &value);
+            if (value.len > 0 && value.start[0] == '{' &&
+                mcp_find_agent_id(&value, out, depth + 1)) {
+                return 1;
+            }
+        }
+
+        while (i < len && s[i] != ',' && s[i] != '}') i++;
+        if (i < len && s[i] == ',') i++;
+    }
+    return 0;
+}
+
+uint32_t mcp_fnv1a(const char *s, uint32_t seed) {
+    uint32_t h = seed;
+
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 0x01000193u;
+    }
+    return h;
+}
+
+/* WebSocket frame header parsing (RFC 6455), shared with the dissector's
+ * plausibility rules: RSV2/RSV3 are always zero, the opcode must be a
+ * defined one, control frames are unfragmented with small payloads. */
+int mcp_ws_parse_header(const uint8_t *buf, size_t len, mcp_ws_hdr_t *hdr) {
+    size_t header_len = 2;
+    uint8_t b0, len_byte;
+
+    if (len < 2) {
+        return MCP_WS_HDR_MORE;
+    }
+    b0 = buf[0];
+    hdr->fin = (b0 & 0x80) != 0;
+    hdr->rsv1 = (b0 & 0x40) != 0;
+    hdr->opcode = b0 & 0x0F;
+
+    if (b0 & 0x30) {
+        return MCP_WS_HDR_MALFORMED; /* RSV2/RSV3 */
+    }
+    switch (hdr->opcode) {
+        case 0: case 1: case 2:    /* Continuation, text, binary */
+        case 8: case 9: case 10:   /* Close, ping, pong */
+            break;
+        default:
+            return MCP_WS_HDR_MALFORMED;
+    }
+
+    len_byte = buf[1];
+    hdr->masked = (len_byte & 0x80) != 0;
+    hdr->payload_len = len_byte & 0x7F;
+
+    if (hdr->opcode >= 8 && (!hdr->fin || hdr->payload_len > 125)) {
+        return MCP_WS_HDR_MALFORMED;
+    }
+
+    if (hdr->payload_len == 126) {
+        if (len < header_len + 2) return MCP_WS_HDR_MORE;
+        hdr->payload_len = ((uint64_t)buf[2] << 8) | buf[3];
+        header_len += 2;
+    } else if (hdr->payload_len == 127) {
+        if (len < header_len + 8) return MCP_WS_HDR_MORE;
+        hdr->payload_len =
+            ((uint64_t)buf[2] << 56) | ((uint64_t)buf[3] << 48) |
+            ((uint64_t)buf[4] << 40) | ((uint64_t)buf[5] << 32) |
+            ((uint64_t)buf[6] << 24) | ((uint64_t)buf[7] << 16) |
+            ((uint64_t)buf[8] << 8)  |  (uint64_t)buf[9];
+        header_len += 8;
+    }
+
+    if (hdr->masked) {
+        if (len < header_len + 4) return MCP_WS_HDR_MORE;
+        memcpy(hdr->mask_key, buf + header_len, 4);
+        header_len += 4;
+    } else {
+        memset(hdr->mask_key, 0, 4);
+    }
+
+    hdr->header_len = header_len;
+    return MCP_WS_HDR_OK;
+}
+
+void mcp_ws_unmask(uint8_t *buf, size_t len, const uint8_t mask_key[4]) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] ^= mask_key[i & 3];
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * MCP parse core: the WebSocket frame-header and JSON-RPC extraction logic
+ * shared by the Wireshark dissector plugin and the standalone tools
+ * (mcpgrep). Deliberately free of Wireshark and glib dependencies so it
+ * links into anything.
+ */
+
+#ifndef MCP_CORE_H
+#define MCP_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A byte range inside a payload buffer. The parser never copies: every
+ * extracted field is a span over the caller's buffer. */
+typedef struct {
+    const char *start;
+    size_t len;
+} mcp_span_t;
+
+/* Parsed JSON-RPC message. The parser fills only the spans; the *_str
+ * members are left NULL for callers (like the dissector) that derive
+ * allocator-backed strings from the spans afterwards. */
+typedef struct {
+    mcp_span_t jsonrpc;
+    mcp_span_t method;
+    mcp_span_t id;
+    mcp_span_t params;
+    mcp_span_t result;
+    mcp_span_t error_code_span;
+    mcp_span_t error_message;
+    mcp_span_t agent_id;
+    mcp_span_t ciphertext;
+    mcp_span_t iv;
+    mcp_span_t ratchet_header;
+    int error_code;          /* 0 when the message carries no error */
+    int encrypted;
+    const char *method_str;
+    char *id_str;
+    const char *agent_id_str;
+} mcp_json_data_t;
+
+/* Field-selection masks for mcp_parse_json_rpc: members nobody asked for
+ * are skipped (span walk only), and the walk stops early once every wanted
+ * field was seen. */
+#define MCP_WANT_JSONRPC    (1u << 0)
+#define MCP_WANT_METHOD     (1u << 1)
+#define MCP_WANT_ID         (1u << 2)
+#define MCP_WANT_PARAMS     (1u << 3)
+#define MCP_WANT_RESULT     (1u << 4)
+#define MCP_WANT_ERROR      (1u << 5)
+#define MCP_WANT_ENCRYPTION (1u << 6)
+#define MCP_WANT_AGENT_ID   (1u << 7)
+#define MCP_WANT_ALL        0xffffffffu
+
+/* Everything columns, correlation and the tap need on every pass */
+#define MCP_WANT_SUMMARY    (MCP_WANT_JSONRPC | MCP_WANT_METHOD | MCP_WANT_ID | \
+                             MCP_WANT_ERROR | MCP_WANT_ENCRYPTION | MCP_WANT_AGENT_ID)
+
+/* Pick the widest structural scanner the CPU supports (AVX2/SSE2/scalar).
+ * Call once before parsing; safe to call again. */
+void mcp_scan_select_impl(void);
+
+/* Single-pass tokenizer over one JSON-RPC envelope. Records the spans of
+ * the wanted top-level members into 'data' (which the caller zeroed). */
+void mcp_parse_json_rpc(const char *buf, size_t len, mcp_json_data_t *data,
+                        unsigned wanted);
+
+/* Find a top-level string member of an object span; no descent into nested
+ * objects. Returns nonzero and the value span on a hit. */
+int mcp_find_member_string(const mcp_span_t *obj, const char *name, mcp_span_t *out);
+
+/* Search an object span for an "agentId"/"agent_id" member, descending into
+ * nested objects up to a small depth bound. Call with depth 0. */
+int mcp_find_agent_id(const mcp_span_t *obj, mcp_span_t *out, int depth);
+
+/* FNV-1a over a NUL-terminated string; the seed comes from the generated
+ * method table so every known method lands in its own slot. */
+uint32_t mcp_fnv1a(const char *s, uint32_t seed);
+
+/* One parsed WebSocket frame header (RFC 6455) */
+typedef struct {
+    unsigned fin;
+    unsigned rsv1;           /* permessage-deflate */
+    unsigned opcode;
+    unsigned masked;
+    uint8_t mask_key[4];
+    uint64_t payload_len;
+    size_t header_len;       /* Bytes consumed by the header itself */
+} mcp_ws_hdr_t;
+
+#define MCP_WS_HDR_OK         1
+#define MCP_WS_HDR_MORE       0   /* Buffer ends inside the header */
+#define MCP_WS_HDR_MALFORMED (-1) /* Not a plausible frame header */
+
+/* Parse one frame header from the start of 'buf'. Applies the same
+ * plausibility rules as the dissector (RSV2/RSV3 zero, defined opcodes,
+ * control-frame limits). */
+int mcp_ws_parse_header(const uint8_t *buf, size_t len, mcp_ws_hdr_t *hdr);
+
+/* XOR-unmask a client-to-server payload in place */
+void mcp_ws_unmask(uint8_t *buf, size_t len, const uint8_t mask_key[4]);
+
+#endif /* MCP_CORE_H */
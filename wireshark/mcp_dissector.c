@@ -11,8 +11,25 @@
 #include <epan/proto_data.h>
 #include <epan/to_str.h>
 #include <epan/wmem/wmem.h>
+#include <epan/dissectors/packet-tcp.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/srt_table.h>
+#include <epan/stats_tree.h>
+#include <epan/expert.h>
 #include <wsutil/str_util.h>
 
+#include "mcp_core.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_GCRYPT
+#include <epan/uat.h>
+#include <wsutil/wsgcrypt.h>
+#endif
+
 /* Protocol and field registration */
 static int proto_mcp = -1;
 static int proto_mcp_ws = -1;
@@ -26,16 +43,54 @@ static int hf_mcp_result = -1;
 static int hf_mcp_error_code = -1;
 static int hf_mcp_error_message = -1;
 static int hf_mcp_agent_id = -1;
+static int hf_mcp_request_method = -1;
+static int hf_mcp_rtt = -1;
+static int hf_mcp_agent_msg_seq = -1;
+static int hf_mcp_params_truncated = -1;
 static int hf_mcp_encrypted = -1;
 static int hf_mcp_ciphertext = -1;
 static int hf_mcp_iv = -1;
 static int hf_mcp_ratchet_header = -1;
+static int hf_mcp_decrypted = -1;
+
+/* Tap for statistics (-z mcp,srt) */
+static int mcp_tap = -1;
+
+/* Dissector handle, shared by the port registration and the heuristic */
+static dissector_handle_t mcp_handle;
+
+/* Sidecar index state: path preference, the file being written on the
+ * first pass, and the records loaded from an existing index on reopen,
+ * keyed by (frame, message ordinal). */
+static const char *mcp_index_path = "";
+static FILE *mcp_index_fp;
+static wmem_map_t *mcp_frame_index;
+
+/* Map keys are (frame << 16 | ordinal) as full 64-bit values (stored
+ * file-scope, hashed with g_int64_hash), so frame numbers never alias no
+ * matter how large the capture gets. */
+#define MCP_INDEX_KEY(frame, idx) (((guint64)(frame) << 16) | ((guint64)(idx) & 0xFFFF))
+
+/* Identity stamp loaded from the index header plus whether a dissected
+ * frame has confirmed it yet; see mcp_index_lookup(). */
+static guint32 mcp_index_first_frame;
+static guint64 mcp_index_first_secs;
+static guint32 mcp_index_first_nsecs;
+static gboolean mcp_index_verified;
+
+/* Expert info */
+static expert_field ei_mcp_payload_truncated = EI_INIT;
+static expert_field ei_mcp_malformed_frame = EI_INIT;
+static expert_field ei_mcp_frame_truncated = EI_INIT;
+static expert_field ei_mcp_decrypt_failed = EI_INIT;
 
 /* WebSocket fields */
 static int hf_ws_opcode = -1;
 static int hf_ws_fin = -1;
+static int hf_ws_mask = -1;
 static int hf_ws_payload_length = -1;
 static int hf_ws_payload = -1;
+static int hf_ws_payload_raw = -1;
 
 /* Subtree indices */
 static gint ett_mcp = -1;
@@ -43,7 +98,34 @@ static gint ett_mcp_ws = -1;
 static gint ett_mcp_encryption = -1;
 
 /* Preferences */
-static guint mcp_port = 8082;
+#define MCP_TCP_PORT_DEFAULT "8082"
+static range_t *mcp_tcp_port_range = NULL;
+/* Parse/display at most this many payload bytes (0 = unlimited). Training
+ * notifications carry params blobs of hundreds of KB; the cap keeps the GUI
+ * responsive while full parsing stays one preference flip away. */
+static guint mcp_parse_cap = 4096;
+/* Summary mode: column-only passes probe the first few hundred bytes for
+ * the method name and skip the full parse on a hit. Opt-in, because the
+ * cheap path also skips request/response correlation and per-agent
+ * accounting for the messages it serves. */
+static gboolean mcp_summary_mode = FALSE;
+
+#ifdef HAVE_GCRYPT
+/* Session key table (UAT): maps an agent/session id to the key material
+ * both sides derive their ratchet chains from. A row with an empty agent id
+ * matches any session, for captures where the plaintext initialize that
+ * names the agent is missing. */
+typedef struct {
+    char *agent_id;
+    char *secret;
+} mcp_ratchet_key_t;
+
+static mcp_ratchet_key_t *mcp_ratchet_keys;
+static guint mcp_ratchet_num_keys;
+
+UAT_CSTRING_CB_DEF(mcp_ratchet_keys, agent_id, mcp_ratchet_key_t)
+UAT_CSTRING_CB_DEF(mcp_ratchet_keys, secret, mcp_ratchet_key_t)
+#endif
 
 /* MCP Method constants */
 typedef struct {
@@ -51,628 +133,2544 @@ typedef struct {
     const char *description;
 } mcp_method_t;
 
-static const mcp_method_t mcp_methods[] = {
-    {"initialize", "Initialize MCP connection"},
-    {"tools/list", "List available tools"},
-    {"resources/list", "List available resources"},
-    {"tools/call", "Call a tool"},
-    {"resources/read", "Read a resource"},
-    {"notifications/initialized", "Connection initialized notification"},
-    {"notifications/chess/game_state", "Chess game state notification"},
-    {"notifications/chess/ai_move", "AI move notification"},
-    {"notifications/chess/training_progress", "Training progress notification"},
-    {NULL, NULL}
-};
-
-static const mcp_method_t chess_tools[] = {
-    {"create_chess_game", "Create new chess game"},
-    {"make_chess_move", "Make a chess move"},
-    {"get_board_state", "Get current board state"},
-    {"analyze_position", "Analyze chess position"},
-    {"get_legal_moves", "Get legal moves"},
-    {"get_move_hint", "Get move hint"},
-    {"create_tournament", "Create tournament"},
-    {"get_tournament_status", "Get tournament status"},
-    {NULL, NULL}
-};
-
-static const mcp_method_t chess_resources[] = {
-    {"chess://ai-systems", "AI systems information"},
-    {"chess://opening-book", "Opening book database"},
-    {"chess://game-history", "Game history"},
-    {"chess://training-data", "Training data"},
-    {"chess://performance-metrics", "Performance metrics"},
-    {NULL, NULL}
-};
-
-/* JSON parsing helper structures */
+/* Generated perfect-hash table over the union of MCP methods, chess tools
+ * and chess resources. Edit mcp_methods.txt and rerun gen_mcp_methods.py;
+ * the same manifest keeps mcp_dissector.lua's tables in sync. */
+#include "mcp_methods.h"
+
+/* Per-conversation dissection state. Fragmented messages (FIN=0 frames
+ * followed by continuation frames) are accumulated here, one buffer per
+ * direction, and parsed once when the FIN=1 continuation arrives. The
+ * permessage-deflate context is also per direction: RFC 7692 context
+ * takeover means the inflate window carries across messages, so one
+ * z_stream must live as long as the conversation rather than being
+ * initialized and torn down per packet. */
+typedef struct {
+    wmem_strbuf_t *frag_buf[2]; /* In-flight fragmented message, NULL when idle */
+    wmem_map_t *req_methods;    /* JSON-RPC id -> request method label */
+#ifdef HAVE_ZLIB
+    z_stream inflate_strm[2];
+    gboolean inflate_ready[2];
+#endif
+#ifdef HAVE_GCRYPT
+    /* Ratchet decryption state, derived once per session instead of per
+     * packet: the chain key comes from the UAT secret on first use, the
+     * per-direction counters mirror each side's sending chain for envelopes
+     * whose ratchet header omits the message counter. */
+    const char *agent_id;       /* From the plaintext initialize; interned */
+    guint8 chain_key[32];
+    gboolean chain_ready;
+    gboolean no_session_key;    /* Negative key lookup, cached */
+    guint32 ratchet_count[2];
+#endif
+} mcp_conv_t;
+
+/* Inflated payload cached for GUI re-dissection: context takeover makes
+ * decompression order-dependent, so it can only run on the first
+ * sequential pass */
+typedef struct {
+    guint8 *data;
+    guint len;
+} mcp_cached_buf_t;
+
+/* Per-request state kept in the conversation's id map: the display label
+ * for correlated responses, the SRT bucket key (tool name for tools/call,
+ * method otherwise), and the request timestamp for mcp.rtt */
+typedef struct {
+    const char *label;
+    const char *srt_method;
+    nstime_t req_time;
+    guint32 req_frame;
+} mcp_req_entry_t;
+
+/* Per-message data handed to the mcp tap (-z mcp,srt and the statistics
+ * tree). Everything here is already extracted for the tree/columns, so the
+ * tap costs no extra parsing. */
+typedef struct {
+    const char *srt_method;
+    const char *method;   /* Raw method, NULL on responses */
+    const char *id;
+    gboolean is_response;
+    gboolean has_rtt;
+    nstime_t req_time;
+    gint error_code;      /* 0 when the message carries no error */
+    gboolean encrypted;
+    const char *agent_id;
+} mcp_tap_info_t;
+
+/* Cached parse results, stored in file-scope proto_data on the first pass
+ * so GUI re-dissection (click, filter change, redraw) skips the JSON walk.
+ * Spans are stored as offsets: the payload's backing buffer can move
+ * between passes, but the bytes are identical. The strings are file-scope
+ * (interned or copied) and stable. */
 typedef struct {
-    char *jsonrpc;
-    char *method;
-    char *id;
-    char *params;
-    char *result;
+    guint32 off;
+    guint32 len;
+} mcp_span_off_t;
+
+typedef struct {
+    mcp_span_off_t jsonrpc, method, id, params, result;
+    mcp_span_off_t error_code_span, error_message, agent_id;
+    mcp_span_off_t ciphertext, iv, ratchet_header;
     int error_code;
-    char *error_message;
-    char *agent_id;
     gboolean encrypted;
-    char *ciphertext;
-    char *iv;
-    char *ratchet_header;
-} mcp_json_data_t;
+    const char *method_str;
+    const char *id_str;
+    const char *agent_id_str;
+    guint wanted;       /* Mask this cache entry was parsed with */
+    guint32 parsed_len; /* Bytes the parse covered (after the cap); a pass
+                         * whose effective length is larger must re-parse,
+                         * e.g. after mcp.payload_parse_cap was raised */
+} mcp_cached_msg_t;
+
+/* Sidecar index (preference mcp.index_file): a compact fixed-record file
+ * written alongside the capture on the first pass and loaded on reopen.
+ * Records are host byte order and padding-free, so a reader can mmap the
+ * file and treat it as an array. Delete the file to force a rebuild. */
+#define MCP_INDEX_MAGIC     0x5850434du /* "MCPX" on disk, little-endian */
+#define MCP_INDEX_VERSION   2
+#define MCP_INDEX_AGENT_LEN 10
+
+#define MCP_IDX_RESPONSE    0x0001
+#define MCP_IDX_ERROR       0x0002
+#define MCP_IDX_ENCRYPTED   0x0004
+
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    guint32 record_size;
+    guint32 first_frame;    /* Identity stamp: number and timestamp of the
+                             * first indexed frame, rewritten at close.
+                             * Nothing is served from a loaded index until a
+                             * dissected frame confirms the stamp, since the
+                             * path preference is global and could point at
+                             * an index built from a different capture. */
+    guint64 first_ts_secs;
+    guint32 first_ts_nsecs;
+    guint32 reserved;
+} mcp_index_hdr_t;          /* 32 bytes */
+
+typedef struct {
+    guint32 frame;
+    guint16 msg_idx;      /* Ordinal of the message within its frame */
+    guint16 method_slot;  /* mcp_method_table slot; 0xFFFF when not in the table.
+                           * For responses this is the correlated request's method. */
+    gint32  error_code;
+    guint16 flags;        /* MCP_IDX_* */
+    char    agent[MCP_INDEX_AGENT_LEN]; /* NUL-terminated, truncated */
+} mcp_index_rec_t;        /* 24 bytes */
+
+/* Per-agent session stats, accumulated during the first sequential pass.
+ * Keyed by agent_id in a file-scoped map (auto-reset when the capture file
+ * closes), so per-agent breakdowns need no re-scan. */
+typedef struct {
+    guint32 msgs;
+    guint32 first_frame;
+    guint32 last_frame;
+} mcp_agent_t;
+
+static wmem_map_t *mcp_agents;
+
+/* Intern table for repeated strings (methods, agent ids): a large capture
+ * holds millions of messages but only a handful of distinct values, so
+ * canonical file-scope copies replace per-packet wmem_strdup churn. */
+static wmem_map_t *mcp_interned;
+
+/* WebSocket frame header: 2 fixed bytes, then 2 or 8 extended-length bytes
+ * for the 126/127 encodings. */
+#define MCP_WS_MIN_HEADER 2
+
+/* p_add_proto_data keys under proto_mcp. Packet-pool (per-dissection)
+ * counter keys first; a batched segment carries several frames, so each
+ * cache that is written once per frame keeps its own ordinal counter and
+ * offsets its file-scope base by it. The bases are far enough apart that
+ * the offsets of one cache cannot run into the next. */
+#define MCP_PDATA_MSG_ORDINAL 3
+#define MCP_PDATA_INFLATED_ORDINAL 4
+#define MCP_PDATA_REASSEMBLED_ORDINAL 5
+/* Per-message agent sequence numbers, offset by the message's dissect
+ * ordinal in the packet */
+#define MCP_PDATA_AGENT_SEQ 16
+/* Per-message cached parse results, same per-ordinal offsetting */
+#define MCP_PDATA_PARSED 0x10000
+/* Inflated payloads, per compressed frame within the packet */
+#define MCP_PDATA_INFLATED 0x20000
+/* Reassembled messages, per completing FIN frame within the packet */
+#define MCP_PDATA_REASSEMBLED 0x30000
+/* Decrypted plaintext cached for re-dissection, per dissect ordinal */
+#define MCP_PDATA_DECRYPTED 0x40000
 
 /* Forward declarations */
+void proto_reg_handoff_mcp(void);
 static int dissect_mcp_websocket(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data);
-static void parse_json_rpc(const char *json_str, mcp_json_data_t *data);
+static guint get_mcp_ws_frame_len(packet_info *pinfo, tvbuff_t *tvb, int offset, void *data);
+static int dissect_mcp_ws_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data);
+static tvbuff_t *unmask_payload(tvbuff_t *tvb, packet_info *pinfo, guint offset, guint payload_len, const guint8 *mask_key);
+#ifdef HAVE_ZLIB
+static tvbuff_t *inflate_payload(tvbuff_t *payload_tvb, packet_info *pinfo);
+#endif
+static void dissect_mcp_fragment(tvbuff_t *payload_tvb, packet_info *pinfo, proto_tree *ws_tree, guint8 opcode, guint8 fin);
+static void dissect_mcp_json(tvbuff_t *payload_tvb, packet_info *pinfo, proto_tree *ws_tree);
+static void parse_json_rpc_buf(const char *buf, gsize len, mcp_json_data_t *data, guint wanted);
 static const char *get_method_description(const char *method);
-static void extract_agent_id(const char *params, char *agent_id, size_t agent_id_len);
+static guint32 mcp_method_hash(const char *method);
+static char *span_strdup_scope(wmem_allocator_t *scope, const mcp_span_t *span);
+static char *span_strdup(const mcp_span_t *span);
+static const char *mcp_intern_span(const mcp_span_t *span);
+static guint32 mcp_account_agent(packet_info *pinfo, const char *agent_id, guint ordinal);
+static void mcp_probe_init(void);
+
+/* Number of MCP messages already dissected from the current packet. The
+ * Chess MCP Server batches notifications, so one TCP segment routinely
+ * carries several small frames; this lets COL_INFO list all of them instead
+ * of each frame overwriting the previous one. Reset on every entry, which
+ * happens once per (re-)dissection of a packet. */
+static guint mcp_msgs_in_packet;
+
+/* Dissect ordinal within the current frame: advanced on EVERY
+ * dissect_mcp_json invocation, accepted or not. Per-message proto_data and
+ * index records key on this rather than mcp_msgs_in_packet, because that
+ * counter moves only for accepted messages -- a non-JSON-RPC frame batched
+ * ahead of a valid one, or a probe pass accepting what the full parse
+ * rejects, would otherwise shift every later message onto its neighbour's
+ * cache entry.
+ *
+ * The counter lives in packet-pool proto_data rather than a static reset on
+ * entry: packet-tcp invokes the dissector more than once for a frame whose
+ * segment completes a spanning PDU and still carries further frames, and a
+ * static reset would rewind the ordinal between those invocations, colliding
+ * the file-scope per-message keys. The pool lives for exactly one
+ * (re-)dissection of the frame, so the counter spans all invocations of a
+ * pass and still starts from zero on the next one. */
+static guint mcp_pool_counter_next(packet_info *pinfo, guint32 key) {
+    guint n = GPOINTER_TO_UINT(p_get_proto_data(pinfo->pool, pinfo, proto_mcp, key));
+
+    p_add_proto_data(pinfo->pool, pinfo, proto_mcp, key, GUINT_TO_POINTER(n + 1));
+    return n;
+}
+#ifdef HAVE_GCRYPT
+/* Set while dissecting the plaintext of an encrypted envelope, so the
+ * column, the tap and the index still describe the message as encrypted
+ * on the wire */
+static gboolean mcp_in_decrypted;
+#endif
 static void free_mcp_data(mcp_json_data_t *data);
 
-/* Protocol registration */
-void proto_register_mcp(void) {
-    static hf_register_info hf[] = {
-        { &hf_mcp_version, {
-            "MCP Version", "mcp.version",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Model Context Protocol version", HFILL }
-        },
-        { &hf_mcp_method, {
-            "Method", "mcp.method",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "JSON-RPC method name", HFILL }
-        },
-        { &hf_mcp_id, {
-            "Request ID", "mcp.id",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "JSON-RPC request/response ID", HFILL }
-        },
-        { &hf_mcp_params, {
-            "Parameters", "mcp.params",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Method parameters", HFILL }
-        },
-        { &hf_mcp_result, {
-            "Result", "mcp.result",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Method result", HFILL }
-        },
-        { &hf_mcp_error_code, {
-            "Error Code", "mcp.error_code",
-            FT_INT32, BASE_DEC, NULL, 0x0,
-            "JSON-RPC error code", HFILL }
-        },
-        { &hf_mcp_error_message, {
-            "Error Message", "mcp.error_message",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "JSON-RPC error message", HFILL }
-        },
-        { &hf_mcp_agent_id, {
-            "Agent ID", "mcp.agent_id",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "MCP agent identifier", HFILL }
-        },
-        { &hf_mcp_encrypted, {
-            "Encrypted", "mcp.encrypted",
-            FT_BOOLEAN, 8, NULL, 0x0,
-            "Message is encrypted", HFILL }
-        },
-        { &hf_mcp_ciphertext, {
-            "Ciphertext", "mcp.ciphertext",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Encrypted message content", HFILL }
-        },
-        { &hf_mcp_iv, {
-            "IV", "mcp.iv",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Initialization vector", HFILL }
-        },
-        { &hf_mcp_ratchet_header, {
-            "Ratchet Header", "mcp.ratchet_header",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "Double ratchet header", HFILL }
-        },
-        { &hf_ws_opcode, {
-            "WebSocket Opcode", "mcp_ws.opcode",
-            FT_UINT8, BASE_DEC, NULL, 0x0,
-            "WebSocket frame opcode", HFILL }
-        },
-        { &hf_ws_fin, {
-            "FIN", "mcp_ws.fin",
-            FT_BOOLEAN, 8, NULL, 0x0,
-            "WebSocket FIN flag", HFILL }
-        },
-        { &hf_ws_payload_length, {
-            "Payload Length", "mcp_ws.payload_length",
-            FT_UINT32, BASE_DEC, NULL, 0x0,
-            "WebSocket payload length", HFILL }
-        },
-        { &hf_ws_payload, {
-            "WebSocket Payload", "mcp_ws.payload",
-            FT_STRING, BASE_NONE, NULL, 0x0,
-            "WebSocket frame payload", HFILL }
-        }
-    };
+/* Service response time table (-z mcp,srt): one row per known method or
+ * tool, mapped from its slot in the generated hash table. */
+static int mcp_srt_row_of[MCP_METHOD_HASH_SIZE];
 
-    static gint *ett[] = {
-        &ett_mcp,
-        &ett_mcp_ws,
-        &ett_mcp_encryption
-    };
+static void mcp_srt_table_init(struct register_srt *srt, GArray *srt_array) {
+    srt_stat_table *tbl;
+    int i, rows = 0;
 
-    proto_mcp = proto_register_protocol("Model Context Protocol", "MCP", "mcp");
-    proto_register_field_array(proto_mcp, hf, array_length(hf));
-    proto_register_subtree_array(ett, array_length(ett));
+    (void)srt;
 
-    proto_mcp_ws = proto_register_protocol("MCP over WebSocket", "MCP-WS", "mcp_ws");
+    for (i = 0; i < MCP_METHOD_HASH_SIZE; i++) {
+        mcp_srt_row_of[i] = mcp_method_table[i].method ? rows++ : -1;
+    }
+    tbl = init_srt_table("MCP Requests", NULL, srt_array, rows, NULL, "mcp.method", NULL);
+    for (i = 0; i < MCP_METHOD_HASH_SIZE; i++) {
+        if (mcp_srt_row_of[i] >= 0) {
+            init_srt_table_row(tbl, mcp_srt_row_of[i], mcp_method_table[i].method);
+        }
+    }
 }
 
-/* Handoff registration */
-void proto_reg_handoff_mcp(void) {
-    static dissector_handle_t mcp_handle;
-    static gboolean initialized = FALSE;
+static tap_packet_status mcp_srt_packet(void *pss, packet_info *pinfo,
+                                        struct epan_dissect *edt, const void *prv,
+                                        tap_flags_t flags) {
+    srt_data_t *data = (srt_data_t *)pss;
+    const mcp_tap_info_t *info = (const mcp_tap_info_t *)prv;
+    srt_stat_table *tbl;
+    guint32 slot;
+    int row;
 
-    if (!initialized) {
-        mcp_handle = create_dissector_handle(dissect_mcp_websocket, proto_mcp_ws);
-        dissector_add_uint("tcp.port", mcp_port, mcp_handle);
-        initialized = TRUE;
+    (void)edt;
+    (void)flags;
+
+    if (!info->is_response || !info->has_rtt || !info->srt_method) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    slot = mcp_method_hash(info->srt_method);
+    if (!mcp_method_table[slot].method ||
+        strcmp(info->srt_method, mcp_method_table[slot].method) != 0) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    row = mcp_srt_row_of[slot];
+    if (row < 0) {
+        return TAP_PACKET_DONT_REDRAW;
     }
+
+    tbl = g_array_index(data->srt_array, srt_stat_table *, 0);
+    add_srt_table_data(tbl, row, &info->req_time, pinfo);
+    return TAP_PACKET_REDRAW;
 }
 
-/* Main dissector function */
-static int dissect_mcp_websocket(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data) {
-    guint offset = 0;
-    guint8 fin, opcode;
-    guint16 payload_len_16;
-    guint64 payload_len_64;
-    guint32 payload_len;
-    tvbuff_t *payload_tvb;
-    char *payload_str;
-    mcp_json_data_t json_data = {0};
-    proto_tree *ws_tree, *mcp_tree, *encryption_tree;
-    proto_item *ti;
+/* Statistics tree (tshark -z mcp,tree): message counts per method, the
+ * error-code distribution and the encrypted/plaintext split, all from the
+ * fields the dissector already extracted -- no second pass required. */
+static int st_node_messages = -1;
+static int st_node_methods = -1;
+static int st_node_errors = -1;
+static int st_node_encryption = -1;
+static int st_node_agents = -1;
 
-    /* Parse WebSocket frame header */
-    if (tvb_captured_length(tvb) < 2) {
-        return 0;
-    }
+static const gchar *st_str_messages = "Messages";
+static const gchar *st_str_methods = "Methods";
+static const gchar *st_str_errors = "Error Codes";
+static const gchar *st_str_encryption = "Encryption";
+static const gchar *st_str_agents = "Agents";
 
-    fin = (tvb_get_guint8(tvb, 0) & 0x80) >> 7;
-    opcode = tvb_get_guint8(tvb, 0) & 0x0F;
-    offset = 1;
+static void mcp_stats_tree_init(stats_tree *st) {
+    st_node_messages = stats_tree_create_node(st, st_str_messages, 0, STAT_DT_INT, TRUE);
+    st_node_methods = stats_tree_create_node(st, st_str_methods, 0, STAT_DT_INT, TRUE);
+    st_node_errors = stats_tree_create_node(st, st_str_errors, 0, STAT_DT_INT, TRUE);
+    st_node_encryption = stats_tree_create_node(st, st_str_encryption, 0, STAT_DT_INT, TRUE);
+    st_node_agents = stats_tree_create_node(st, st_str_agents, 0, STAT_DT_INT, TRUE);
+}
 
-    payload_len = tvb_get_guint8(tvb, 1) & 0x7F;
-    offset = 2;
+static tap_packet_status mcp_stats_tree_packet(stats_tree *st, packet_info *pinfo,
+                                               struct epan_dissect *edt, const void *prv,
+                                               tap_flags_t flags) {
+    const mcp_tap_info_t *info = (const mcp_tap_info_t *)prv;
 
-    if (payload_len == 126) {
-        if (tvb_captured_length(tvb) < offset + 2) return 0;
-        payload_len_16 = tvb_get_ntohs(tvb, offset);
-        payload_len = payload_len_16;
-        offset += 2;
-    } else if (payload_len == 127) {
-        if (tvb_captured_length(tvb) < offset + 8) return 0;
-        payload_len_64 = tvb_get_ntoh64(tvb, offset);
-        payload_len = (guint32)payload_len_64;
-        offset += 8;
+    (void)pinfo;
+    (void)edt;
+    (void)flags;
+
+    tick_stat_node(st, st_str_messages, 0, FALSE);
+
+    if (info->srt_method) {
+        stats_tree_tick_pivot(st, st_node_methods, info->srt_method);
     }
 
-    /* Create WebSocket subtree */
-    ws_tree = proto_tree_add_subtree(tree, tvb, 0, offset + payload_len, ett_mcp_ws, NULL, "MCP WebSocket");
-    
-    ti = proto_tree_add_uint(ws_tree, hf_ws_opcode, tvb, 0, 1, opcode);
-    proto_item_append_text(ti, " (%s)", (opcode == 1) ? "Text" : "Binary");
+    if (info->error_code != 0) {
+        gchar code_str[16];
+        snprintf(code_str, sizeof(code_str), "%d", info->error_code);
+        stats_tree_tick_pivot(st, st_node_errors, code_str);
+    }
 
-    proto_tree_add_boolean(ws_tree, hf_ws_fin, tvb, 0, 1, fin);
-    proto_tree_add_uint(ws_tree, hf_ws_payload_length, tvb, 1, offset - 1, payload_len);
+    stats_tree_tick_pivot(st, st_node_encryption,
+                          info->encrypted ? "Encrypted" : "Plaintext");
 
-    if (payload_len > 0 && offset + payload_len <= tvb_captured_length(tvb)) {
-        payload_tvb = tvb_new_subset_length(tvb, offset, payload_len);
-        proto_tree_add_item(ws_tree, hf_ws_payload, payload_tvb, 0, -1, ENC_ASCII);
+    if (info->agent_id) {
+        int agent_node = stats_tree_tick_pivot(st, st_node_agents, info->agent_id);
+        if (info->srt_method) {
+            tick_stat_node(st, info->srt_method, agent_node, FALSE);
+        }
+    }
 
-        /* Only process text frames (opcode 1) */
-        if (opcode == 1) {
-            payload_str = tvb_get_string_enc(wmem_packet_scope(), payload_tvb, 0, -1, ENC_ASCII);
-            
-            /* Parse JSON-RPC */
-            parse_json_rpc(payload_str, &json_data);
-            
-            if (json_data.jsonrpc && strcmp(json_data.jsonrpc, "2.0") == 0) {
-                /* Create MCP subtree */
-                mcp_tree = proto_tree_add_subtree(ws_tree, payload_tvb, 0, -1, ett_mcp, NULL, "Model Context Protocol");
-
-                /* Add basic fields */
-                if (json_data.jsonrpc) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_version, payload_tvb, 0, 0, json_data.jsonrpc);
-                }
+    return TAP_PACKET_REDRAW;
+}
 
-                if (json_data.method) {
-                    const char *method_desc = get_method_description(json_data.method);
-                    ti = proto_tree_add_string(mcp_tree, hf_mcp_method, payload_tvb, 0, 0, json_data.method);
-                    if (method_desc) {
-                        proto_item_append_text(ti, " (%s)", method_desc);
-                    }
-                }
+/* NDJSON export (tshark -z mcp,export,<file>): one JSON line per MCP
+ * message, streamed through a buffered writer during the normal dissection
+ * pass. Replaces the `tshark -T fields` pipeline stage, which forced a
+ * complete second dissection of every capture. */
+#define MCP_EXPORT_BUF_SIZE (256 * 1024)
 
-                if (json_data.id) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_id, payload_tvb, 0, 0, json_data.id);
-                }
+static FILE *mcp_export_fp;
+static char *mcp_export_iobuf;
 
-                /* Add encryption fields if present */
-                if (json_data.encrypted) {
-                    encryption_tree = proto_tree_add_subtree(mcp_tree, payload_tvb, 0, 0, ett_mcp_encryption, NULL, "Encryption");
-                    proto_tree_add_boolean(encryption_tree, hf_mcp_encrypted, payload_tvb, 0, 0, TRUE);
-                    
-                    if (json_data.ciphertext) {
-                        proto_tree_add_string(encryption_tree, hf_mcp_ciphertext, payload_tvb, 0, 0, json_data.ciphertext);
-                    }
-                    if (json_data.iv) {
-                        proto_tree_add_string(encryption_tree, hf_mcp_iv, payload_tvb, 0, 0, json_data.iv);
-                    }
-                    if (json_data.ratchet_header) {
-                        proto_tree_add_string(encryption_tree, hf_mcp_ratchet_header, payload_tvb, 0, 0, json_data.ratchet_header);
-                    }
-                }
+/* Minimal JSON string escaping: the values are already JSON string contents,
+ * so only the quote, backslash and control characters need re-escaping. */
+static void mcp_export_string(FILE *fp, const char *key, const char *val) {
+    fprintf(fp, ",\"%s\":\"", key);
+    for (; *val; val++) {
+        unsigned char c = (unsigned char)*val;
+        if (c == '"' || c == '\\') {
+            fprintf(fp, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(fp, "\\u%04x", c);
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
 
-                /* Add params/result/error */
-                if (json_data.params) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_params, payload_tvb, 0, 0, json_data.params);
-                }
+static tap_packet_status mcp_export_packet(void *tapdata, packet_info *pinfo,
+                                           struct epan_dissect *edt, const void *prv,
+                                           tap_flags_t flags) {
+    const mcp_tap_info_t *info = (const mcp_tap_info_t *)prv;
+    FILE *fp = mcp_export_fp;
 
-                if (json_data.result) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_result, payload_tvb, 0, 0, json_data.result);
-                }
+    (void)tapdata;
+    (void)edt;
+    (void)flags;
 
-                if (json_data.error_code != 0) {
-                    proto_tree_add_int(mcp_tree, hf_mcp_error_code, payload_tvb, 0, 0, json_data.error_code);
-                }
+    fprintf(fp, "{\"frame\":%u,\"time\":%ld.%09d", pinfo->num,
+            (long)pinfo->abs_ts.secs, pinfo->abs_ts.nsecs);
+    if (info->method) {
+        mcp_export_string(fp, "method", info->method);
+    }
+    if (info->is_response && info->srt_method) {
+        mcp_export_string(fp, "request_method", info->srt_method);
+    }
+    if (info->id) {
+        mcp_export_string(fp, "id", info->id);
+    }
+    if (info->agent_id) {
+        mcp_export_string(fp, "agent_id", info->agent_id);
+    }
+    if (info->is_response) {
+        fputs(",\"response\":true", fp);
+    }
+    if (info->error_code != 0) {
+        fprintf(fp, ",\"error_code\":%d", info->error_code);
+    }
+    if (info->encrypted) {
+        fputs(",\"encrypted\":true", fp);
+    }
+    fputs("}\n", fp);
+    return TAP_PACKET_DONT_REDRAW;
+}
 
-                if (json_data.error_message) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_error_message, payload_tvb, 0, 0, json_data.error_message);
-                }
+static void mcp_export_draw(void *tapdata) {
+    (void)tapdata;
+    fflush(mcp_export_fp);
+}
 
-                if (json_data.agent_id) {
-                    proto_tree_add_string(mcp_tree, hf_mcp_agent_id, payload_tvb, 0, 0, json_data.agent_id);
-                }
+static void mcp_export_finish(void *tapdata) {
+    (void)tapdata;
+    fclose(mcp_export_fp);
+    mcp_export_fp = NULL;
+    g_free(mcp_export_iobuf);
+    mcp_export_iobuf = NULL;
+}
 
-                /* Set protocol info */
-                col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
-                if (json_data.method) {
-                    col_add_fstr(pinfo->cinfo, COL_INFO, "MCP %s", json_data.method);
-                    if (json_data.encrypted) {
-                        col_append_str(pinfo->cinfo, COL_INFO, " (Encrypted)");
-                    }
-                }
+static void mcp_export_init(const char *opt_arg, void *userdata) {
+    static const char prefix[] = "mcp,export,";
+    const char *path;
+    GString *err;
 
-                /* Color coding for errors */
-                if (json_data.error_code != 0) {
-                    col_append_fstr(pinfo->cinfo, COL_INFO, " [ERROR %d]", json_data.error_code);
-                }
-            }
+    (void)userdata;
 
-            /* Clean up */
-            free_mcp_data(&json_data);
-        }
+    if (strncmp(opt_arg, prefix, sizeof(prefix) - 1) != 0 ||
+        opt_arg[sizeof(prefix) - 1] == '\0') {
+        fprintf(stderr, "mcp: usage is -z mcp,export,<outfile>\n");
+        exit(1);
     }
+    path = opt_arg + sizeof(prefix) - 1;
 
-    return offset + payload_len;
+    mcp_export_fp = fopen(path, "w");
+    if (!mcp_export_fp) {
+        fprintf(stderr, "mcp: cannot open %s for writing\n", path);
+        exit(1);
+    }
+    mcp_export_iobuf = (char *)g_malloc(MCP_EXPORT_BUF_SIZE);
+    setvbuf(mcp_export_fp, mcp_export_iobuf, _IOFBF, MCP_EXPORT_BUF_SIZE);
+
+    err = register_tap_listener("mcp", &mcp_export_fp, NULL, 0,
+                                NULL, mcp_export_packet, mcp_export_draw,
+                                mcp_export_finish);
+    if (err) {
+        fprintf(stderr, "mcp: %s\n", err->str);
+        exit(1);
+    }
 }
 
-/* JSON parsing helper functions */
-static void parse_json_rpc(const char *json_str, mcp_json_data_t *data) {
-    char *json_copy = wmem_strdup(wmem_packet_scope(), json_str);
-    char *pos, *end, *value_start, *value_end;
-    char agent_id[256] = {0};
-
-    /* Extract jsonrpc version */
-    pos = strstr(json_copy, "\"jsonrpc\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++; /* Skip ':' */
-            while (*pos == ' ' || *pos == '\t') pos++; /* Skip whitespace */
-            if (*pos == '"') {
-                pos++; /* Skip opening quote */
-                value_start = pos;
-                end = strchr(pos, '"');
-                if (end) {
-                    *end = '\0';
-                    data->jsonrpc = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '"'; /* Restore */
-                }
-            }
+/* Rolling throughput monitor (tshark -i eth0 -z mcp,io).
+ *
+ * One-second buckets in fixed rings, keyed by the same method slots the
+ * perfect-hash table provides, so the per-packet cost is a handful of
+ * array increments: no allocation, no sorting, no string formatting until
+ * the periodic draw. The draw prints a rolling summary of the last
+ * window -- per-method and per-agent rates, error and encryption counts --
+ * which is what a load test needs to watch without re-running a full-file
+ * analysis on every refresh. */
+#define MCP_IO_RING         60 /* Seconds of history */
+#define MCP_IO_WINDOW       10 /* Seconds summarized per draw */
+#define MCP_IO_AGENT_SLOTS  16
+#define MCP_IO_AGENT_LEN    24
+
+typedef struct {
+    guint32 methods[MCP_METHOD_HASH_SIZE];
+    guint32 other;          /* Methods outside the generated table */
+    guint32 total;
+    guint32 responses;
+    guint32 errors;
+    guint32 encrypted;
+    guint32 agents[MCP_IO_AGENT_SLOTS];
+} mcp_io_bucket_t;
+
+static mcp_io_bucket_t mcp_io_ring[MCP_IO_RING];
+static char mcp_io_agent_names[MCP_IO_AGENT_SLOTS][MCP_IO_AGENT_LEN];
+static guint mcp_io_agent_count;
+static time_t mcp_io_last_sec;
+static gboolean mcp_io_started;
+static int mcp_io_tapdata; /* Listener identity only */
+
+static void mcp_io_reset(void *tapdata) {
+    (void)tapdata;
+    memset(mcp_io_ring, 0, sizeof(mcp_io_ring));
+    memset(mcp_io_agent_names, 0, sizeof(mcp_io_agent_names));
+    mcp_io_agent_count = 0;
+    mcp_io_started = FALSE;
+}
+
+/* Fixed agent slot table: bounded linear probe, first-come allocation.
+ * Load tests run a handful of agents; overflow lands in slot 0's overflow
+ * counter implicitly by being dropped from the per-agent view. */
+static int mcp_io_agent_slot(const char *agent_id) {
+    guint i;
+
+    for (i = 0; i < mcp_io_agent_count; i++) {
+        if (strcmp(mcp_io_agent_names[i], agent_id) == 0) {
+            return (int)i;
         }
     }
+    if (mcp_io_agent_count < MCP_IO_AGENT_SLOTS) {
+        g_strlcpy(mcp_io_agent_names[mcp_io_agent_count], agent_id, MCP_IO_AGENT_LEN);
+        return (int)mcp_io_agent_count++;
+    }
+    return -1;
+}
 
-    /* Extract method */
-    pos = strstr(json_copy, "\"method\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '"') {
-                pos++;
-                value_start = pos;
-                end = strchr(pos, '"');
-                if (end) {
-                    *end = '\0';
-                    data->method = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '"';
-                }
-            }
-        }
+static tap_packet_status mcp_io_packet(void *tapdata, packet_info *pinfo,
+                                       struct epan_dissect *edt, const void *prv,
+                                       tap_flags_t flags) {
+    const mcp_tap_info_t *info = (const mcp_tap_info_t *)prv;
+    mcp_io_bucket_t *b;
+    time_t sec = pinfo->abs_ts.secs;
+    const char *method;
+
+    (void)tapdata;
+    (void)edt;
+    (void)flags;
+
+    if (!mcp_io_started) {
+        mcp_io_last_sec = sec;
+        mcp_io_started = TRUE;
     }
+    if (sec > mcp_io_last_sec) {
+        /* Advance the ring, clearing the buckets the clock skipped */
+        time_t t = mcp_io_last_sec + 1;
 
-    /* Extract ID */
-    pos = strstr(json_copy, "\"id\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '"') {
-                pos++;
-                value_start = pos;
-                end = strchr(pos, '"');
-                if (end) {
-                    *end = '\0';
-                    data->id = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '"';
-                }
-            } else {
-                /* Numeric ID */
-                value_start = pos;
-                end = pos;
-                while (*end && *end != ',' && *end != '}') end++;
-                if (end > value_start) {
-                    *end = '\0';
-                    data->id = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = (*end == ',') ? ',' : '}';
-                }
-            }
+        if (sec - t >= MCP_IO_RING) {
+            t = sec - (MCP_IO_RING - 1);
+        }
+        for (; t <= sec; t++) {
+            memset(&mcp_io_ring[t % MCP_IO_RING], 0, sizeof(mcp_io_bucket_t));
         }
+        mcp_io_last_sec = sec;
+    } else if (mcp_io_last_sec - sec >= MCP_IO_RING) {
+        return TAP_PACKET_DONT_REDRAW; /* Older than the ring remembers */
     }
 
-    /* Check for encryption */
-    pos = strstr(json_copy, "\"encrypted\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (strncmp(pos, "true", 4) == 0) {
-                data->encrypted = TRUE;
-                
-                /* Extract ciphertext */
-                pos = strstr(json_copy, "\"ciphertext\"");
-                if (pos) {
-                    pos = strchr(pos, ':');
-                    if (pos) {
-                        pos++;
-                        while (*pos == ' ' || *pos == '\t') pos++;
-                        if (*pos == '"') {
-                            pos++;
-                            value_start = pos;
-                            end = strchr(pos, '"');
-                            if (end) {
-                                *end = '\0';
-                                data->ciphertext = wmem_strdup(wmem_packet_scope(), value_start);
-                                *end = '"';
-                            }
-                        }
-                    }
-                }
+    b = &mcp_io_ring[sec % MCP_IO_RING];
+    b->total++;
+    if (info->is_response) {
+        b->responses++;
+    }
+    if (info->error_code != 0) {
+        b->errors++;
+    }
+    if (info->encrypted) {
+        b->encrypted++;
+    }
 
-                /* Extract IV */
-                pos = strstr(json_copy, "\"iv\"");
-                if (pos) {
-                    pos = strchr(pos, ':');
-                    if (pos) {
-                        pos++;
-                        while (*pos == ' ' || *pos == '\t') pos++;
-                        if (*pos == '"') {
-                            pos++;
-                            value_start = pos;
-                            end = strchr(pos, '"');
-                            if (end) {
-                                *end = '\0';
-                                data->iv = wmem_strdup(wmem_packet_scope(), value_start);
-                                *end = '"';
-                            }
-                        }
-                    }
-                }
+    /* Responses count under the method of the request they answer */
+    method = info->method ? info->method : info->srt_method;
+    if (method) {
+        guint32 slot = mcp_method_hash(method);
 
-                /* Extract ratchet header */
-                pos = strstr(json_copy, "\"ratchet_header\"");
-                if (pos) {
-                    pos = strchr(pos, ':');
-                    if (pos) {
-                        pos++;
-                        while (*pos == ' ' || *pos == '\t') pos++;
-                        if (*pos == '{') {
-                            value_start = pos;
-                            int brace_count = 0;
-                            end = pos;
-                            while (*end) {
-                                if (*end == '{') brace_count++;
-                                else if (*end == '}') {
-                                    brace_count--;
-                                    if (brace_count == 0) {
-                                        end++;
-                                        break;
-                                    }
-                                }
-                                end++;
-                            }
-                            if (end > value_start) {
-                                *end = '\0';
-                                data->ratchet_header = wmem_strdup(wmem_packet_scope(), value_start);
-                                *end = '}';
-                            }
-                        }
-                    }
-                }
-            }
+        if (mcp_method_table[slot].method &&
+            strcmp(method, mcp_method_table[slot].method) == 0) {
+            b->methods[slot]++;
+        } else {
+            b->other++;
         }
     }
+    if (info->agent_id) {
+        int aslot = mcp_io_agent_slot(info->agent_id);
 
-    /* Extract params */
-    pos = strstr(json_copy, "\"params\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '{') {
-                value_start = pos;
-                int brace_count = 0;
-                end = pos;
-                while (*end) {
-                    if (*end == '{') brace_count++;
-                    else if (*end == '}') {
-                        brace_count--;
-                        if (brace_count == 0) {
-                            end++;
-                            break;
-                        }
-                    }
-                    end++;
-                }
-                if (end > value_start) {
-                    *end = '\0';
-                    data->params = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '}';
-                    
-                    /* Try to extract agent ID from params */
-                    extract_agent_id(data->params, agent_id, sizeof(agent_id));
-                    if (strlen(agent_id) > 0) {
-                        data->agent_id = wmem_strdup(wmem_packet_scope(), agent_id);
-                    }
-                }
-            }
+        if (aslot >= 0) {
+            b->agents[aslot]++;
         }
     }
+    return TAP_PACKET_REDRAW;
+}
 
-    /* Extract result */
-    pos = strstr(json_copy, "\"result\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '{') {
-                value_start = pos;
-                int brace_count = 0;
-                end = pos;
-                while (*end) {
-                    if (*end == '{') brace_count++;
-                    else if (*end == '}') {
-                        brace_count--;
-                        if (brace_count == 0) {
-                            end++;
-                            break;
-                        }
-                    }
-                    end++;
-                }
-                if (end > value_start) {
-                    *end = '\0';
-                    data->result = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '}';
+static void mcp_io_draw(void *tapdata) {
+    guint32 methods[MCP_METHOD_HASH_SIZE] = {0};
+    guint32 agents[MCP_IO_AGENT_SLOTS] = {0};
+    guint32 total = 0, responses = 0, errors = 0, encrypted = 0, other = 0;
+    guint window = MCP_IO_WINDOW;
+    guint i, slot;
+    time_t t;
+
+    (void)tapdata;
+
+    if (!mcp_io_started) {
+        return;
+    }
+    for (t = mcp_io_last_sec; t > mcp_io_last_sec - (time_t)window && t >= 0; t--) {
+        const mcp_io_bucket_t *b = &mcp_io_ring[t % MCP_IO_RING];
+
+        total += b->total;
+        responses += b->responses;
+        errors += b->errors;
+        encrypted += b->encrypted;
+        other += b->other;
+        for (slot = 0; slot < MCP_METHOD_HASH_SIZE; slot++) {
+            methods[slot] += b->methods[slot];
+        }
+        for (i = 0; i < mcp_io_agent_count; i++) {
+            agents[i] += b->agents[i];
+        }
+    }
+
+    printf("\n=== MCP I/O (last %us) ===\n", window);
+    printf("%u messages (%.1f/s), %u responses, %u errors, %u encrypted\n",
+           total, (double)total / window, responses, errors, encrypted);
+    for (slot = 0; slot < MCP_METHOD_HASH_SIZE; slot++) {
+        if (methods[slot]) {
+            printf("  %-40s %6.1f/s\n", mcp_method_table[slot].method,
+                   (double)methods[slot] / window);
+        }
+    }
+    if (other) {
+        printf("  %-40s %6.1f/s\n", "(not in method table)", (double)other / window);
+    }
+    for (i = 0; i < mcp_io_agent_count; i++) {
+        if (agents[i]) {
+            printf("  agent %-34s %6.1f/s\n", mcp_io_agent_names[i],
+                   (double)agents[i] / window);
+        }
+    }
+}
+
+static void mcp_io_init(const char *opt_arg, void *userdata) {
+    GString *err;
+
+    (void)opt_arg;
+    (void)userdata;
+
+    mcp_io_reset(NULL);
+    err = register_tap_listener("mcp", &mcp_io_tapdata, NULL, 0,
+                                mcp_io_reset, mcp_io_packet, mcp_io_draw, NULL);
+    if (err) {
+        fprintf(stderr, "mcp: %s\n", err->str);
+        exit(1);
+    }
+}
+
+/* Per-agent session report (-z mcp,agents): one row per agent id with its
+ * message count, first/last frame and the known methods it used. Counts and
+ * frame bounds come straight from the mcp_agents session table the dissector
+ * maintains anyway; the listener only records which method-table slots each
+ * agent touched, as a bitmap. */
+#define MCP_AGENTS_SLOTS 64
+
+typedef struct {
+    char name[MCP_IO_AGENT_LEN];
+    guint64 methods[MCP_METHOD_HASH_SIZE / 64]; /* Bitmap over table slots */
+    gboolean other;                             /* Methods outside the table */
+} mcp_agents_row_t;
+
+static mcp_agents_row_t mcp_agents_rows[MCP_AGENTS_SLOTS];
+static guint mcp_agents_row_count;
+static int mcp_agents_tapdata; /* Listener identity only */
+
+static void mcp_agents_reset(void *tapdata) {
+    (void)tapdata;
+    memset(mcp_agents_rows, 0, sizeof(mcp_agents_rows));
+    mcp_agents_row_count = 0;
+}
+
+static mcp_agents_row_t *mcp_agents_find_row(const char *agent_id) {
+    guint i;
+
+    for (i = 0; i < mcp_agents_row_count; i++) {
+        if (strcmp(mcp_agents_rows[i].name, agent_id) == 0) {
+            return &mcp_agents_rows[i];
+        }
+    }
+    if (mcp_agents_row_count < MCP_AGENTS_SLOTS) {
+        g_strlcpy(mcp_agents_rows[mcp_agents_row_count].name, agent_id, MCP_IO_AGENT_LEN);
+        return &mcp_agents_rows[mcp_agents_row_count++];
+    }
+    return NULL;
+}
+
+static tap_packet_status mcp_agents_packet(void *tapdata, packet_info *pinfo,
+                                           struct epan_dissect *edt, const void *prv,
+                                           tap_flags_t flags) {
+    const mcp_tap_info_t *info = (const mcp_tap_info_t *)prv;
+    mcp_agents_row_t *row;
+    const char *method;
+
+    (void)tapdata;
+    (void)pinfo;
+    (void)edt;
+    (void)flags;
+
+    if (!info->agent_id) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    row = mcp_agents_find_row(info->agent_id);
+    if (!row) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    /* Responses count under the method of the request they answer */
+    method = info->method ? info->method : info->srt_method;
+    if (method) {
+        guint32 slot = mcp_method_hash(method);
+
+        if (mcp_method_table[slot].method &&
+            strcmp(method, mcp_method_table[slot].method) == 0) {
+            row->methods[slot / 64] |= (guint64)1 << (slot % 64);
+        } else {
+            row->other = TRUE;
+        }
+    }
+    return TAP_PACKET_DONT_REDRAW;
+}
+
+static void mcp_agents_draw(void *tapdata) {
+    guint i, slot;
+
+    (void)tapdata;
+
+    printf("\n=== MCP Agents ===\n");
+    for (i = 0; i < mcp_agents_row_count; i++) {
+        const mcp_agents_row_t *row = &mcp_agents_rows[i];
+        const mcp_agent_t *agent = mcp_agents
+            ? (const mcp_agent_t *)wmem_map_lookup(mcp_agents, row->name) : NULL;
+        gboolean first = TRUE;
+
+        if (agent) {
+            printf("%-24s %8u msgs  frames %u-%u\n", row->name,
+                   agent->msgs, agent->first_frame, agent->last_frame);
+        } else {
+            printf("%-24s\n", row->name);
+        }
+        printf("  methods:");
+        for (slot = 0; slot < MCP_METHOD_HASH_SIZE; slot++) {
+            if (row->methods[slot / 64] & ((guint64)1 << (slot % 64))) {
+                printf("%s %s", first ? "" : ",", mcp_method_table[slot].method);
+                first = FALSE;
+            }
+        }
+        if (row->other) {
+            printf("%s %s", first ? "" : ",", "(not in method table)");
+            first = FALSE;
+        }
+        if (first) {
+            printf(" (none)");
+        }
+        printf("\n");
+    }
+}
+
+static void mcp_agents_init(const char *opt_arg, void *userdata) {
+    GString *err;
+
+    (void)opt_arg;
+    (void)userdata;
+
+    mcp_agents_reset(NULL);
+    err = register_tap_listener("mcp", &mcp_agents_tapdata, NULL, 0,
+                                mcp_agents_reset, mcp_agents_packet, mcp_agents_draw, NULL);
+    if (err) {
+        fprintf(stderr, "mcp: %s\n", err->str);
+        exit(1);
+    }
+}
+
+/* Sidecar index for instant reopen (preference mcp.index_file).
+ *
+ * First pass over a fresh capture: every MCP message appends one fixed
+ * record (frame, ordinal, method slot, agent, error/encryption flags)
+ * through the buffered writer. On reopen the records are loaded into a
+ * file-scope map and column-only passes are served straight from it --
+ * method/agent-filtered packet lists populate without touching the JSON,
+ * while tree passes still parse lazily on demand. */
+static guint16 mcp_method_slot(const char *method) {
+    guint32 slot;
+
+    if (!method) {
+        return 0xFFFF;
+    }
+    slot = mcp_method_hash(method);
+    if (mcp_method_table[slot].method && strcmp(method, mcp_method_table[slot].method) == 0) {
+        return (guint16)slot;
+    }
+    return 0xFFFF;
+}
+
+/* Capture-file init routine: load an existing index, or start writing a
+ * new one. An existing index is never overwritten; delete it to rebuild. */
+static void mcp_index_open(void) {
+    FILE *fp;
+    mcp_index_hdr_t hdr;
+
+    mcp_index_first_frame = 0;
+    mcp_index_first_secs = 0;
+    mcp_index_first_nsecs = 0;
+    mcp_index_verified = FALSE;
+
+    if (!mcp_index_path || !*mcp_index_path) {
+        return;
+    }
+
+    fp = fopen(mcp_index_path, "rb");
+    if (fp) {
+        if (fread(&hdr, sizeof hdr, 1, fp) == 1 &&
+            hdr.magic == MCP_INDEX_MAGIC &&
+            hdr.version == MCP_INDEX_VERSION &&
+            hdr.record_size == sizeof(mcp_index_rec_t) &&
+            hdr.first_frame != 0) {
+            mcp_index_rec_t *rec = wmem_new(wmem_file_scope(), mcp_index_rec_t);
+
+            mcp_index_first_frame = hdr.first_frame;
+            mcp_index_first_secs = hdr.first_ts_secs;
+            mcp_index_first_nsecs = hdr.first_ts_nsecs;
+            mcp_frame_index = wmem_map_new(wmem_file_scope(), g_int64_hash, g_int64_equal);
+            while (fread(rec, sizeof *rec, 1, fp) == 1) {
+                guint64 *key = wmem_new(wmem_file_scope(), guint64);
+
+                *key = MCP_INDEX_KEY(rec->frame, rec->msg_idx);
+                wmem_map_insert(mcp_frame_index, key, rec);
+                rec = wmem_new(wmem_file_scope(), mcp_index_rec_t);
+            }
+        }
+        fclose(fp);
+        return;
+    }
+
+    fp = fopen(mcp_index_path, "wb");
+    if (!fp) {
+        return; /* Unwritable path: dissection proceeds without an index */
+    }
+    memset(&hdr, 0, sizeof hdr);
+    hdr.magic = MCP_INDEX_MAGIC;
+    hdr.version = MCP_INDEX_VERSION;
+    hdr.record_size = sizeof(mcp_index_rec_t);
+    fwrite(&hdr, sizeof hdr, 1, fp);
+    mcp_index_fp = fp;
+}
+
+static void mcp_index_close(void) {
+    if (mcp_index_fp) {
+        /* Rewrite the header with the identity stamp gathered during the
+         * pass; an index that saw no messages keeps first_frame == 0 and is
+         * treated as absent on load. */
+        if (mcp_index_first_frame != 0 && fseek(mcp_index_fp, 0, SEEK_SET) == 0) {
+            mcp_index_hdr_t hdr;
+
+            memset(&hdr, 0, sizeof hdr);
+            hdr.magic = MCP_INDEX_MAGIC;
+            hdr.version = MCP_INDEX_VERSION;
+            hdr.record_size = sizeof(mcp_index_rec_t);
+            hdr.first_frame = mcp_index_first_frame;
+            hdr.first_ts_secs = mcp_index_first_secs;
+            hdr.first_ts_nsecs = mcp_index_first_nsecs;
+            fwrite(&hdr, sizeof hdr, 1, mcp_index_fp);
+        }
+        fclose(mcp_index_fp);
+        mcp_index_fp = NULL;
+    }
+    mcp_frame_index = NULL; /* Records are file-scope, freed with the capture */
+}
+
+/* Look up this message's index record, gating on capture identity. Until a
+ * dissected frame has confirmed the header stamp, nothing is served: the
+ * stamped frame itself must match on number and timestamp, and a record hit
+ * on any other frame first can only mean the index belongs to a different
+ * capture (the stamped frame is the earliest one with a record, and the
+ * sequential pass reaches it before any other hit). Either mismatch drops
+ * the loaded index for the rest of the session. */
+static const mcp_index_rec_t *mcp_index_lookup(packet_info *pinfo, guint ordinal) {
+    guint64 key;
+    const mcp_index_rec_t *rec;
+
+    if (!mcp_frame_index) {
+        return NULL;
+    }
+    key = MCP_INDEX_KEY(pinfo->num, ordinal);
+    rec = (const mcp_index_rec_t *)wmem_map_lookup(mcp_frame_index, &key);
+    if (!mcp_index_verified) {
+        if (pinfo->num == mcp_index_first_frame) {
+            if ((guint64)pinfo->abs_ts.secs != mcp_index_first_secs ||
+                (guint32)pinfo->abs_ts.nsecs != mcp_index_first_nsecs) {
+                mcp_frame_index = NULL;
+                return NULL;
+            }
+            mcp_index_verified = TRUE;
+        } else if (rec) {
+            mcp_frame_index = NULL;
+            return NULL;
+        }
+    }
+    return rec;
+}
+
+static void mcp_index_write(packet_info *pinfo, const mcp_json_data_t *d,
+                            const mcp_req_entry_t *req, guint ordinal) {
+    mcp_index_rec_t rec;
+
+    if (mcp_index_first_frame == 0) {
+        mcp_index_first_frame = pinfo->num;
+        mcp_index_first_secs = (guint64)pinfo->abs_ts.secs;
+        mcp_index_first_nsecs = (guint32)pinfo->abs_ts.nsecs;
+    }
+
+    memset(&rec, 0, sizeof rec);
+    rec.frame = pinfo->num;
+    rec.msg_idx = (guint16)ordinal;
+    rec.method_slot = mcp_method_slot(req ? req->srt_method : d->method_str);
+    rec.error_code = d->error_code;
+    if (!d->method_str) {
+        rec.flags |= MCP_IDX_RESPONSE;
+    }
+    if (d->error_code != 0) {
+        rec.flags |= MCP_IDX_ERROR;
+    }
+    if (d->encrypted) {
+        rec.flags |= MCP_IDX_ENCRYPTED;
+    }
+    if (d->agent_id_str) {
+        g_strlcpy(rec.agent, d->agent_id_str, sizeof rec.agent);
+    }
+    fwrite(&rec, sizeof rec, 1, mcp_index_fp);
+}
+
+/* Serve one message from its index record: columns, agent accounting and
+ * the tap, with no JSON tokenization. Only used on column-only passes;
+ * anything that opens the tree falls through to the full parse. */
+static void mcp_dissect_from_index(const mcp_index_rec_t *rec, packet_info *pinfo,
+                                   guint ordinal) {
+    const char *method = (rec->method_slot < MCP_METHOD_HASH_SIZE)
+        ? mcp_method_table[rec->method_slot].method : NULL;
+    const char *agent = rec->agent[0] ? rec->agent : NULL;
+    mcp_tap_info_t *tap_info;
+
+    if (agent) {
+        mcp_account_agent(pinfo, agent, ordinal);
+    }
+
+    col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
+    if (rec->flags & MCP_IDX_RESPONSE) {
+        if (method) {
+            if (mcp_msgs_in_packet == 0) {
+                col_add_fstr(pinfo->cinfo, COL_INFO, "MCP Response (%s)", method);
+            } else {
+                col_append_fstr(pinfo->cinfo, COL_INFO, ", Response (%s)", method);
+            }
+        }
+    } else if (method) {
+        if (mcp_msgs_in_packet == 0) {
+            col_add_fstr(pinfo->cinfo, COL_INFO, "MCP %s", method);
+        } else {
+            col_append_fstr(pinfo->cinfo, COL_INFO, ", %s", method);
+        }
+        if (rec->flags & MCP_IDX_ENCRYPTED) {
+            col_append_str(pinfo->cinfo, COL_INFO, " (Encrypted)");
+        }
+    }
+    if (rec->error_code != 0) {
+        col_append_fstr(pinfo->cinfo, COL_INFO, " [ERROR %d]", rec->error_code);
+    }
+    mcp_msgs_in_packet++;
+
+    tap_info = wmem_new0(wmem_packet_scope(), mcp_tap_info_t);
+    tap_info->srt_method = method;
+    tap_info->method = (rec->flags & MCP_IDX_RESPONSE) ? NULL : method;
+    tap_info->is_response = (rec->flags & MCP_IDX_RESPONSE) != 0;
+    tap_info->error_code = rec->error_code;
+    tap_info->encrypted = (rec->flags & MCP_IDX_ENCRYPTED) != 0;
+    tap_info->agent_id = agent;
+    tap_queue_packet(mcp_tap, pinfo, tap_info);
+}
+
+#ifdef HAVE_GCRYPT
+/* UAT plumbing for the session key table */
+static void *mcp_ratchet_key_copy_cb(void *dst_, const void *src_, size_t len) {
+    mcp_ratchet_key_t *dst = (mcp_ratchet_key_t *)dst_;
+    const mcp_ratchet_key_t *src = (const mcp_ratchet_key_t *)src_;
+
+    (void)len;
+    dst->agent_id = g_strdup(src->agent_id);
+    dst->secret = g_strdup(src->secret);
+    return dst;
+}
+
+static void mcp_ratchet_key_free_cb(void *rec_) {
+    mcp_ratchet_key_t *rec = (mcp_ratchet_key_t *)rec_;
+
+    g_free(rec->agent_id);
+    g_free(rec->secret);
+}
+#endif
+
+/* Protocol registration */
+void proto_register_mcp(void) {
+    module_t *mcp_module;
+    expert_module_t *expert_mcp;
+    static ei_register_info ei[] = {
+        { &ei_mcp_payload_truncated, {
+            "mcp.payload_truncated", PI_PROTOCOL, PI_NOTE,
+            "Payload larger than the parse cap; dissection truncated", EXPFILL }
+        },
+        { &ei_mcp_malformed_frame, {
+            "mcp_ws.malformed", PI_MALFORMED, PI_ERROR,
+            "Bytes do not form a plausible WebSocket frame header", EXPFILL }
+        },
+        { &ei_mcp_frame_truncated, {
+            "mcp_ws.truncated", PI_MALFORMED, PI_WARN,
+            "WebSocket frame header truncated by the capture", EXPFILL }
+        },
+        { &ei_mcp_decrypt_failed, {
+            "mcp.decrypt_failed", PI_DECRYPTION, PI_WARN,
+            "Envelope could not be decrypted with the configured session keys", EXPFILL }
+        }
+    };
+    static hf_register_info hf[] = {
+        { &hf_mcp_version, {
+            "MCP Version", "mcp.version",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Model Context Protocol version", HFILL }
+        },
+        { &hf_mcp_method, {
+            "Method", "mcp.method",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "JSON-RPC method name", HFILL }
+        },
+        { &hf_mcp_id, {
+            "Request ID", "mcp.id",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "JSON-RPC request/response ID", HFILL }
+        },
+        { &hf_mcp_params, {
+            "Parameters", "mcp.params",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Method parameters", HFILL }
+        },
+        { &hf_mcp_result, {
+            "Result", "mcp.result",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Method result", HFILL }
+        },
+        { &hf_mcp_error_code, {
+            "Error Code", "mcp.error_code",
+            FT_INT32, BASE_DEC, NULL, 0x0,
+            "JSON-RPC error code", HFILL }
+        },
+        { &hf_mcp_error_message, {
+            "Error Message", "mcp.error_message",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "JSON-RPC error message", HFILL }
+        },
+        { &hf_mcp_agent_id, {
+            "Agent ID", "mcp.agent_id",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "MCP agent identifier", HFILL }
+        },
+        { &hf_mcp_request_method, {
+            "Request Method", "mcp.request_method",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Method of the request this response answers", HFILL }
+        },
+        { &hf_mcp_rtt, {
+            "Response Time", "mcp.rtt",
+            FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+            "Time between the request and this response", HFILL }
+        },
+        { &hf_mcp_agent_msg_seq, {
+            "Agent Message Sequence", "mcp.agent_msg_seq",
+            FT_UINT32, BASE_DEC, NULL, 0x0,
+            "Ordinal of this message within its agent's session", HFILL }
+        },
+        { &hf_mcp_params_truncated, {
+            "Params Truncated", "mcp.params_truncated",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+            "Payload exceeded the parse cap and was only partially dissected", HFILL }
+        },
+        { &hf_mcp_encrypted, {
+            "Encrypted", "mcp.encrypted",
+            FT_BOOLEAN, 8, NULL, 0x0,
+            "Message is encrypted", HFILL }
+        },
+        { &hf_mcp_ciphertext, {
+            "Ciphertext", "mcp.ciphertext",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Encrypted message content", HFILL }
+        },
+        { &hf_mcp_iv, {
+            "IV", "mcp.iv",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Initialization vector", HFILL }
+        },
+        { &hf_mcp_ratchet_header, {
+            "Ratchet Header", "mcp.ratchet_header",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "Double ratchet header", HFILL }
+        },
+        { &hf_mcp_decrypted, {
+            "Decrypted", "mcp.decrypted",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+            "Payload was decrypted with a configured session key", HFILL }
+        },
+        { &hf_ws_opcode, {
+            "WebSocket Opcode", "mcp_ws.opcode",
+            FT_UINT8, BASE_DEC, NULL, 0x0,
+            "WebSocket frame opcode", HFILL }
+        },
+        { &hf_ws_fin, {
+            "FIN", "mcp_ws.fin",
+            FT_BOOLEAN, 8, NULL, 0x0,
+            "WebSocket FIN flag", HFILL }
+        },
+        { &hf_ws_mask, {
+            "Masked", "mcp_ws.mask",
+            FT_BOOLEAN, 8, NULL, 0x0,
+            "WebSocket payload is masked (client-to-server)", HFILL }
+        },
+        { &hf_ws_payload_length, {
+            "Payload Length", "mcp_ws.payload_length",
+            FT_UINT64, BASE_DEC, NULL, 0x0,
+            "WebSocket payload length", HFILL }
+        },
+        { &hf_ws_payload, {
+            "WebSocket Payload", "mcp_ws.payload",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            "WebSocket frame payload", HFILL }
+        },
+        { &hf_ws_payload_raw, {
+            "Payload Data", "mcp_ws.payload_raw",
+            FT_BYTES, BASE_NONE, NULL, 0x0,
+            "Undissected remainder of a jumbo payload", HFILL }
+        }
+    };
+
+    static gint *ett[] = {
+        &ett_mcp,
+        &ett_mcp_ws,
+        &ett_mcp_encryption
+    };
+
+    mcp_scan_select_impl();
+    mcp_probe_init();
+
+    proto_mcp = proto_register_protocol("Model Context Protocol", "MCP", "mcp");
+    proto_register_field_array(proto_mcp, hf, array_length(hf));
+    proto_register_subtree_array(ett, array_length(ett));
+
+    proto_mcp_ws = proto_register_protocol("MCP over WebSocket", "MCP-WS", "mcp_ws");
+    expert_mcp = expert_register_protocol(proto_mcp);
+    expert_register_field_array(expert_mcp, ei, array_length(ei));
+
+    mcp_module = prefs_register_protocol(proto_mcp, proto_reg_handoff_mcp);
+    range_convert_str(wmem_epan_scope(), &mcp_tcp_port_range, MCP_TCP_PORT_DEFAULT, 65535);
+    prefs_register_range_preference(mcp_module, "tcp.ports",
+                                    "MCP TCP port(s)",
+                                    "TCP ports carrying MCP-over-WebSocket traffic"
+                                    " (e.g. \"8082-8090,9000\" for a multi-instance deployment)",
+                                    &mcp_tcp_port_range, 65535);
+    prefs_register_uint_preference(mcp_module, "payload_parse_cap",
+                                   "Payload parse cap (bytes)",
+                                   "Parse and display at most this many bytes of each"
+                                   " payload; 0 disables the cap",
+                                   10, &mcp_parse_cap);
+    prefs_register_bool_preference(mcp_module, "summary_mode",
+                                   "Column-only summary mode",
+                                   "Serve packet-list lines from a bounded method probe"
+                                   " instead of a full parse; request/response labels and"
+                                   " per-agent stats are skipped for probed messages",
+                                   &mcp_summary_mode);
+    prefs_register_string_preference(mcp_module, "index_file",
+                                     "Sidecar index file",
+                                     "Write a compact per-message index here on the first"
+                                     " pass and reuse it on reopen; empty disables",
+                                     &mcp_index_path);
+
+#ifdef HAVE_GCRYPT
+    {
+        static uat_field_t mcp_ratchet_key_fields[] = {
+            UAT_FLD_CSTRING(mcp_ratchet_keys, agent_id, "Agent ID",
+                            "Agent/session id the key belongs to; empty matches any session"),
+            UAT_FLD_CSTRING(mcp_ratchet_keys, secret, "Key material",
+                            "Session key material both sides derive their ratchet chains from"),
+            UAT_END_FIELDS
+        };
+        uat_t *keys_uat = uat_new("MCP Session Keys",
+                                  sizeof(mcp_ratchet_key_t),
+                                  "mcp_ratchet_keys",
+                                  TRUE,
+                                  &mcp_ratchet_keys,
+                                  &mcp_ratchet_num_keys,
+                                  UAT_AFFECTS_DISSECTION,
+                                  NULL,
+                                  mcp_ratchet_key_copy_cb,
+                                  NULL,
+                                  mcp_ratchet_key_free_cb,
+                                  NULL,
+                                  NULL,
+                                  mcp_ratchet_key_fields);
+        prefs_register_uat_preference(mcp_module, "ratchet_keys",
+                                      "Session keys",
+                                      "Key material for inline Double Ratchet decryption",
+                                      keys_uat);
+    }
+#endif
+
+    mcp_agents = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+                                        wmem_str_hash, g_str_equal);
+    mcp_interned = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+                                          wmem_str_hash, g_str_equal);
+
+    mcp_tap = register_tap("mcp");
+    register_srt_table(proto_mcp, "mcp", 1, mcp_srt_packet, mcp_srt_table_init, NULL);
+    stats_tree_register("mcp", "mcp", "MCP" STATS_TREE_MENU_SEPARATOR "Messages",
+                        0, mcp_stats_tree_packet, mcp_stats_tree_init, NULL);
+
+    {
+        static stat_tap_ui mcp_export_ui = {
+            REGISTER_STAT_GROUP_GENERIC,
+            "MCP message export",
+            "mcp,export",
+            mcp_export_init,
+            0,
+            NULL
+        };
+        register_stat_tap_ui(&mcp_export_ui, NULL);
+    }
+    {
+        static stat_tap_ui mcp_io_ui = {
+            REGISTER_STAT_GROUP_GENERIC,
+            "MCP rolling throughput",
+            "mcp,io",
+            mcp_io_init,
+            0,
+            NULL
+        };
+        register_stat_tap_ui(&mcp_io_ui, NULL);
+    }
+    {
+        static stat_tap_ui mcp_agents_ui = {
+            REGISTER_STAT_GROUP_GENERIC,
+            "MCP per-agent sessions",
+            "mcp,agents",
+            mcp_agents_init,
+            0,
+            NULL
+        };
+        register_stat_tap_ui(&mcp_agents_ui, NULL);
+    }
+
+    register_init_routine(mcp_index_open);
+    register_cleanup_routine(mcp_index_close);
+}
+
+/* Heuristic probe for MCP on non-configured ports (load balancers move the
+ * server onto ephemeral ports). Cost is bounded: a header sanity check and a
+ * 10-byte prefix compare -- parse_json_rpc never runs on a declined packet.
+ * Compressed frames (RSV1) are declined since their payload cannot be probed
+ * without an inflate context; those conversations are picked up once the
+ * port preference covers them. */
+static gboolean dissect_mcp_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data) {
+    static const char jsonrpc_magic[] = "{\"jsonrpc\"";
+#define MCP_MAGIC_LEN ((guint)sizeof(jsonrpc_magic) - 1)
+    guint8 b0, len_byte, opcode;
+    guint header_len = MCP_WS_MIN_HEADER;
+    guint64 payload_len;
+    guint8 probe[MCP_MAGIC_LEN];
+    guint i;
+
+    if (tvb_captured_length(tvb) < MCP_WS_MIN_HEADER) {
+        return FALSE;
+    }
+
+    b0 = tvb_get_guint8(tvb, 0);
+    opcode = b0 & 0x0F;
+
+    /* Only an unfragmented text frame can start a WebSocket MCP exchange,
+     * and RSV2/RSV3 are always zero (RFC 6455) */
+    if (opcode != 1 || !(b0 & 0x80) || (b0 & 0x30)) {
+        return FALSE;
+    }
+    if (b0 & 0x40) {
+        return FALSE; /* RSV1: compressed payload, nothing to probe */
+    }
+
+    len_byte = tvb_get_guint8(tvb, 1);
+    payload_len = len_byte & 0x7F;
+    if (payload_len == 126) {
+        header_len += 2;
+    } else if (payload_len == 127) {
+        header_len += 8;
+    }
+    if (len_byte & 0x80) {
+        header_len += 4; /* Masking key */
+    }
+
+    if (tvb_captured_length(tvb) < header_len + MCP_MAGIC_LEN) {
+        return FALSE;
+    }
+
+    tvb_memcpy(tvb, probe, header_len, MCP_MAGIC_LEN);
+    if (len_byte & 0x80) {
+        guint8 mask_key[4];
+        tvb_memcpy(tvb, mask_key, header_len - 4, 4);
+        for (i = 0; i < MCP_MAGIC_LEN; i++) {
+            probe[i] ^= mask_key[i % 4];
+        }
+    }
+    if (memcmp(probe, jsonrpc_magic, MCP_MAGIC_LEN) != 0) {
+        return FALSE;
+    }
+#undef MCP_MAGIC_LEN
+
+    /* Claim the whole conversation so later frames (continuations,
+     * responses, compressed messages) come straight to us */
+    conversation_set_dissector(find_or_create_conversation(pinfo), mcp_handle);
+    dissect_mcp_websocket(tvb, pinfo, tree, data);
+    return TRUE;
+}
+
+/* Handoff registration. Also the preference apply callback: on a port
+ * range change the old registrations are dropped and the new range bound,
+ * so moving an instance is a preference edit rather than a rebuild. */
+void proto_reg_handoff_mcp(void) {
+    static gboolean initialized = FALSE;
+    static range_t *registered_ports = NULL;
+
+    if (!initialized) {
+        mcp_handle = create_dissector_handle(dissect_mcp_websocket, proto_mcp_ws);
+        heur_dissector_add("tcp", dissect_mcp_heur, "MCP over WebSocket",
+                           "mcp_ws_tcp", proto_mcp_ws, HEURISTIC_ENABLE);
+        initialized = TRUE;
+    } else {
+        dissector_delete_uint_range("tcp.port", registered_ports, mcp_handle);
+        wmem_free(wmem_epan_scope(), registered_ports);
+    }
+
+    registered_ports = range_copy(wmem_epan_scope(), mcp_tcp_port_range);
+    dissector_add_uint_range("tcp.port", registered_ports, mcp_handle);
+}
+
+/* Cheap plausibility check on two header bytes: RSV2/RSV3 are always zero,
+ * the opcode must be a defined one, and control frames are unfragmented
+ * with small payloads (RFC 6455). Used both to spot corruption and to
+ * resynchronize the frame walk after it. */
+static gboolean mcp_ws_header_plausible(tvbuff_t *tvb, int offset) {
+    guint8 b0 = tvb_get_guint8(tvb, offset);
+    guint8 opcode = b0 & 0x0F;
+
+    if (b0 & 0x30) {
+        return FALSE;
+    }
+    switch (opcode) {
+        case 0: case 1: case 2:    /* Continuation, text, binary */
+        case 8: case 9: case 10:   /* Close, ping, pong */
+            break;
+        default:
+            return FALSE;
+    }
+    if (opcode >= 8) {
+        if (!(b0 & 0x80)) {
+            return FALSE; /* Control frames are never fragmented */
+        }
+        if ((tvb_get_guint8(tvb, offset + 1) & 0x7F) > 125) {
+            return FALSE; /* ...and carry at most 125 bytes */
+        }
+    }
+    return TRUE;
+}
+
+/* Report the total length of the frame starting at 'offset' so the TCP
+ * desegmentation machinery can reassemble frames that span segments. */
+static guint get_mcp_ws_frame_len(packet_info *pinfo, tvbuff_t *tvb, int offset, void *data) {
+    guint header_len = MCP_WS_MIN_HEADER;
+    guint8 len_byte;
+    guint64 payload_len;
+
+    (void)pinfo;
+    (void)data;
+
+    /* Corrupt or non-WebSocket bytes: resynchronize by reporting a "frame"
+     * that spans the garbage up to the next plausible header, so one bad
+     * segment costs one flagged gap instead of desynchronizing the whole
+     * stream behind it. */
+    if (!mcp_ws_header_plausible(tvb, offset)) {
+        guint rem = tvb_captured_length_remaining(tvb, offset);
+        guint skip;
+
+        for (skip = 1; skip + MCP_WS_MIN_HEADER <= rem; skip++) {
+            if (mcp_ws_header_plausible(tvb, offset + skip)) {
+                if (skip < MCP_WS_MIN_HEADER) {
+                    /* tcp_dissect_pdus treats a length below its fixed_len
+                     * as a bounds error and abandons the rest of the
+                     * segment. A gap smaller than a header rides along in
+                     * the next frame's PDU instead; dissect_mcp_ws_frame
+                     * peels it off. */
+                    guint next = get_mcp_ws_frame_len(pinfo, tvb, offset + skip, data);
+
+                    return (next > 0xFFFFFFFFu - skip) ? 0xFFFFFFFFu : skip + next;
                 }
+                return skip;
+            }
+        }
+        return rem;
+    }
+
+    len_byte = tvb_get_guint8(tvb, offset + 1);
+    payload_len = len_byte & 0x7F;
+
+    /* tcp_dissect_pdus only guarantees MCP_WS_MIN_HEADER captured bytes; a
+     * segment boundary inside the extended-length field means the length is
+     * not known yet. Like packet-websocket.c, report just the bytes the
+     * header needs so far -- more than what is captured -- so the machinery
+     * desegments and retries instead of throwing a bounds error that would
+     * drop the PDU. */
+    if (payload_len == 126) {
+        if (tvb_captured_length_remaining(tvb, offset + 2) < 2) {
+            return header_len + 2;
+        }
+        payload_len = tvb_get_ntohs(tvb, offset + 2);
+        header_len += 2;
+    } else if (payload_len == 127) {
+        if (tvb_captured_length_remaining(tvb, offset + 2) < 8) {
+            return header_len + 8;
+        }
+        payload_len = tvb_get_ntoh64(tvb, offset + 2);
+        header_len += 8;
+    }
+
+    /* Masked frames (client-to-server, RFC 6455) carry a 4-byte key */
+    if (len_byte & 0x80) {
+        header_len += 4;
+    }
+
+    /* Keep the 64-bit arithmetic intact: truncating a >4 GB length here
+     * shifted every subsequent frame boundary in the stream. A frame that
+     * genuinely exceeds 32-bit tvb addressing can never be fully
+     * reassembled, so report the cap and let the frame dissector handle
+     * the available bytes as a truncated jumbo frame. */
+    if (payload_len > 0xFFFFFFFFu - header_len) {
+        return 0xFFFFFFFFu;
+    }
+
+    return header_len + (guint)payload_len;
+}
+
+/* Main dissector entry point: hand the segment to the TCP desegmentation
+ * machinery, which reassembles frames spanning segments and then calls
+ * dissect_mcp_ws_frame once per complete frame — including every coalesced
+ * frame in the segment. Previously a split frame made us return 0 and the
+ * frame was silently dropped while Wireshark re-invoked us fruitlessly on
+ * every pass, and only the first frame of a batched segment was parsed. */
+static int dissect_mcp_websocket(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data) {
+    mcp_msgs_in_packet = 0;
+    tcp_dissect_pdus(tvb, pinfo, tree, TRUE, MCP_WS_MIN_HEADER,
+                     get_mcp_ws_frame_len, dissect_mcp_ws_frame, data);
+    return tvb_captured_length(tvb);
+}
+
+/* Dissect one complete (reassembled) WebSocket frame carrying an MCP message */
+/* How much of a jumbo payload's head is parsed as JSON; the rest is
+ * registered as raw bytes without being copied through a string. */
+#define MCP_JUMBO_HEAD 16384
+
+static int dissect_mcp_ws_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data) {
+    guint offset = 0;
+    guint8 fin, rsv1, opcode, mask;
+    guint8 mask_key[4];
+    guint16 payload_len_16;
+    guint64 payload_len_64;
+    guint avail, payload_len;
+    tvbuff_t *payload_tvb;
+    proto_tree *ws_tree;
+    proto_item *ti;
+
+    (void)data;
+
+    /* Parse WebSocket frame header */
+    if (tvb_captured_length(tvb) < 2) {
+        return 0;
+    }
+
+    /* A resync gap reported by get_mcp_ws_frame_len lands here as its own
+     * "frame": flag it once and display the bytes raw. A gap smaller than a
+     * header was folded into the next frame's PDU (the length callback may
+     * not report less than tcp_dissect_pdus' fixed length); peel it off and
+     * dissect the frame behind it. */
+    if (!mcp_ws_header_plausible(tvb, 0)) {
+        if (tvb_captured_length(tvb) > MCP_WS_MIN_HEADER && mcp_ws_header_plausible(tvb, 1)) {
+            ws_tree = proto_tree_add_subtree(tree, tvb, 0, 1, ett_mcp_ws, &ti,
+                                             "MCP WebSocket (malformed)");
+            proto_tree_add_item(ws_tree, hf_ws_payload_raw, tvb, 0, 1, ENC_NA);
+            expert_add_info(pinfo, ti, &ei_mcp_malformed_frame);
+            return 1 + dissect_mcp_ws_frame(tvb_new_subset_remaining(tvb, 1),
+                                            pinfo, tree, data);
+        }
+        ws_tree = proto_tree_add_subtree(tree, tvb, 0, -1, ett_mcp_ws, &ti,
+                                         "MCP WebSocket (malformed)");
+        proto_tree_add_item(ws_tree, hf_ws_payload_raw, tvb, 0, -1, ENC_NA);
+        expert_add_info(pinfo, ti, &ei_mcp_malformed_frame);
+        col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
+        col_set_str(pinfo->cinfo, COL_INFO, "[Malformed WebSocket data, resynchronizing]");
+        return tvb_captured_length(tvb);
+    }
+
+    fin = (tvb_get_guint8(tvb, 0) & 0x80) >> 7;
+    rsv1 = (tvb_get_guint8(tvb, 0) & 0x40) >> 6;
+    opcode = tvb_get_guint8(tvb, 0) & 0x0F;
+    offset = 1;
+
+    mask = (tvb_get_guint8(tvb, 1) & 0x80) >> 7;
+    payload_len_64 = tvb_get_guint8(tvb, 1) & 0x7F;
+    offset = 2;
+
+    if (payload_len_64 == 126) {
+        if (tvb_captured_length(tvb) < offset + 2) goto truncated_header;
+        payload_len_16 = tvb_get_ntohs(tvb, offset);
+        payload_len_64 = payload_len_16;
+        offset += 2;
+    } else if (payload_len_64 == 127) {
+        if (tvb_captured_length(tvb) < offset + 8) goto truncated_header;
+        payload_len_64 = tvb_get_ntoh64(tvb, offset);
+        offset += 8;
+    }
+
+    /* Masked (client-to-server) frames carry a 4-byte XOR key */
+    if (mask) {
+        if (tvb_captured_length(tvb) < offset + 4) goto truncated_header;
+        tvb_memcpy(tvb, mask_key, offset, 4);
+        offset += 4;
+    }
+
+    /* A jumbo frame (full chess://game-history reads run past 4 GB) can
+     * never be materialized in one tvb; whatever portion is present gets
+     * chunked treatment below instead of corrupting the length math. */
+    avail = tvb_captured_length_remaining(tvb, offset);
+    payload_len = (payload_len_64 <= avail) ? (guint)payload_len_64 : avail;
+
+    /* Create WebSocket subtree */
+    ws_tree = proto_tree_add_subtree(tree, tvb, 0,
+                                     (payload_len_64 <= avail) ? (gint)(offset + payload_len) : -1,
+                                     ett_mcp_ws, NULL, "MCP WebSocket");
+
+    ti = proto_tree_add_uint(ws_tree, hf_ws_opcode, tvb, 0, 1, opcode);
+    proto_item_append_text(ti, " (%s)", (opcode == 1) ? "Text" : "Binary");
+
+    proto_tree_add_boolean(ws_tree, hf_ws_fin, tvb, 0, 1, fin);
+    proto_tree_add_boolean(ws_tree, hf_ws_mask, tvb, 1, 1, mask);
+    proto_tree_add_uint64(ws_tree, hf_ws_payload_length, tvb, 1, offset - 1, payload_len_64);
+
+    if (payload_len_64 > avail) {
+        /* Chunked dissection of a jumbo/truncated payload: parse the JSON
+         * head (method, id, the envelope) and register the rest as raw
+         * bytes -- no tvb_get_string_enc copy of gigabytes. Compressed
+         * jumbo frames stay opaque: inflating requires the full stream. */
+        guint head_len = (avail < MCP_JUMBO_HEAD) ? avail : MCP_JUMBO_HEAD;
+
+        if (head_len > 0 && !rsv1 && opcode == 1) {
+            if (mask) {
+                payload_tvb = unmask_payload(tvb, pinfo, offset, head_len, mask_key);
+            } else {
+                payload_tvb = tvb_new_subset_length(tvb, offset, head_len);
             }
+            dissect_mcp_json(payload_tvb, pinfo, ws_tree);
         }
+        if (avail > head_len) {
+            proto_tree_add_item(ws_tree, hf_ws_payload_raw, tvb, offset + head_len,
+                                avail - head_len, ENC_NA);
+        }
+        return offset + avail;
     }
 
-    /* Extract error code */
-    pos = strstr(json_copy, "\"code\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '-' || (*pos >= '0' && *pos <= '9')) {
-                data->error_code = (int)strtol(pos, &end, 10);
+    if (payload_len > 0) {
+        if (mask) {
+            payload_tvb = unmask_payload(tvb, pinfo, offset, payload_len, mask_key);
+        } else {
+            payload_tvb = tvb_new_subset_length(tvb, offset, payload_len);
+        }
+
+        /* permessage-deflate: RSV1 marks a compressed message */
+        if (rsv1 && (opcode == 1 || opcode == 0)) {
+#ifdef HAVE_ZLIB
+            payload_tvb = inflate_payload(payload_tvb, pinfo);
+            if (!payload_tvb) {
+                return offset + payload_len;
             }
+#else
+            /* Built without zlib: compressed payloads stay opaque */
+            return offset + payload_len;
+#endif
+        }
+        proto_tree_add_item(ws_tree, hf_ws_payload, payload_tvb, 0, -1, ENC_ASCII);
+
+        if (opcode == 1 && fin) {
+            /* Complete text frame: parse in place over the tvb bytes */
+            dissect_mcp_json(payload_tvb, pinfo, ws_tree);
+        } else if (opcode == 1 || opcode == 0) {
+            /* Fragmented message: accumulate, parse once on the final frame */
+            dissect_mcp_fragment(payload_tvb, pinfo, ws_tree, opcode, fin);
         }
     }
 
-    /* Extract error message */
-    pos = strstr(json_copy, "\"message\"");
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '"') {
-                pos++;
-                value_start = pos;
-                end = strchr(pos, '"');
-                if (end) {
-                    *end = '\0';
-                    data->error_message = wmem_strdup(wmem_packet_scope(), value_start);
-                    *end = '"';
-                }
+    return offset + payload_len;
+
+truncated_header:
+    /* The capture's snap length cut the frame header short; flag it rather
+     * than silently declining, and consume what is present so the walk
+     * does not spin on the same bytes. */
+    ws_tree = proto_tree_add_subtree(tree, tvb, 0, -1, ett_mcp_ws, &ti,
+                                     "MCP WebSocket (truncated header)");
+    expert_add_info(pinfo, ti, &ei_mcp_frame_truncated);
+    return tvb_captured_length(tvb);
+}
+
+/* Unmask a client-to-server payload (RFC 6455 section 5.3) into a
+ * packet-scope scratch buffer, XORing eight bytes per iteration with the
+ * mask key replicated into a 64-bit word, and expose the result as a new
+ * data source so the plaintext is what gets parsed and displayed. */
+static tvbuff_t *unmask_payload(tvbuff_t *tvb, packet_info *pinfo, guint offset, guint payload_len,
+                                const guint8 *mask_key) {
+    guint8 *buf = (guint8 *)wmem_alloc(wmem_packet_scope(), payload_len);
+    guint8 key8[8];
+    guint64 key64, chunk;
+    guint i;
+    tvbuff_t *unmasked_tvb;
+
+    tvb_memcpy(tvb, buf, offset, payload_len);
+
+    for (i = 0; i < 8; i++) {
+        key8[i] = mask_key[i % 4];
+    }
+    memcpy(&key64, key8, 8);
+
+    for (i = 0; i + 8 <= payload_len; i += 8) {
+        memcpy(&chunk, buf + i, 8);
+        chunk ^= key64;
+        memcpy(buf + i, &chunk, 8);
+    }
+    for (; i < payload_len; i++) {
+        buf[i] ^= mask_key[i % 4];
+    }
+
+    unmasked_tvb = tvb_new_child_real_data(tvb, buf, payload_len, payload_len);
+    add_new_data_source(pinfo, unmasked_tvb, "Unmasked WebSocket payload");
+    return unmasked_tvb;
+}
+
+/* Look up (or create) the per-conversation dissection state */
+static mcp_conv_t *get_mcp_conv(packet_info *pinfo) {
+    conversation_t *conv = find_or_create_conversation(pinfo);
+    mcp_conv_t *mcp_conv = (mcp_conv_t *)conversation_get_proto_data(conv, proto_mcp);
+
+    if (!mcp_conv) {
+        mcp_conv = wmem_new0(wmem_file_scope(), mcp_conv_t);
+        mcp_conv->req_methods = wmem_map_new(wmem_file_scope(), wmem_str_hash, g_str_equal);
+        conversation_add_proto_data(conv, proto_mcp, mcp_conv);
+    }
+    return mcp_conv;
+}
+
+#ifdef HAVE_ZLIB
+/* Inflate an RFC 7692 permessage-deflate payload (RSV1 set) using the
+ * conversation's long-lived raw-deflate context for this direction. Runs
+ * only on the first sequential pass -- context takeover makes the stream
+ * order-dependent -- and caches the result in file-scope proto_data so GUI
+ * re-dissection is a lookup, not a re-inflate. Returns NULL if the payload
+ * does not inflate cleanly. */
+static tvbuff_t *inflate_payload(tvbuff_t *payload_tvb, packet_info *pinfo) {
+    mcp_conv_t *conv;
+    mcp_cached_buf_t *cached;
+    z_stream *strm;
+    guint dir = (pinfo->srcport < pinfo->destport) ? 0 : 1;
+    guint in_len = tvb_captured_length(payload_tvb);
+    guint8 *in_buf, *out_buf;
+    guint out_cap, out_len;
+    int zret;
+    tvbuff_t *inflated_tvb;
+    /* A segment routinely carries several compressed frames; the counter
+     * advances per invocation on both passes, so the same frame-within-packet
+     * replays the same cache slot */
+    guint ordinal = mcp_pool_counter_next(pinfo, MCP_PDATA_INFLATED_ORDINAL);
+
+    if (pinfo->fd->visited) {
+        cached = (mcp_cached_buf_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                                                      MCP_PDATA_INFLATED + ordinal);
+        if (!cached) {
+            return NULL;
+        }
+        inflated_tvb = tvb_new_child_real_data(payload_tvb, cached->data, cached->len, cached->len);
+        add_new_data_source(pinfo, inflated_tvb, "Inflated WebSocket payload");
+        return inflated_tvb;
+    }
+
+    conv = get_mcp_conv(pinfo);
+    strm = &conv->inflate_strm[dir];
+    if (!conv->inflate_ready[dir]) {
+        memset(strm, 0, sizeof(*strm));
+        if (inflateInit2(strm, -MAX_WBITS) != Z_OK) {
+            return NULL;
+        }
+        conv->inflate_ready[dir] = TRUE;
+    }
+
+    /* RFC 7692 7.2.2: re-append the 00 00 ff ff tail stripped on the wire */
+    in_buf = (guint8 *)wmem_alloc(wmem_packet_scope(), in_len + 4);
+    tvb_memcpy(payload_tvb, in_buf, 0, in_len);
+    in_buf[in_len] = 0x00;
+    in_buf[in_len + 1] = 0x00;
+    in_buf[in_len + 2] = 0xff;
+    in_buf[in_len + 3] = 0xff;
+
+    out_cap = in_len * 4 + 256;
+    out_buf = (guint8 *)wmem_alloc(wmem_file_scope(), out_cap);
+    out_len = 0;
+
+    strm->next_in = in_buf;
+    strm->avail_in = in_len + 4;
+    for (;;) {
+        strm->next_out = out_buf + out_len;
+        strm->avail_out = out_cap - out_len;
+        zret = inflate(strm, Z_SYNC_FLUSH);
+        out_len = out_cap - strm->avail_out;
+        if (zret == Z_OK || zret == Z_BUF_ERROR) {
+            if (strm->avail_in == 0 && strm->avail_out > 0) {
+                break; /* Whole message consumed */
+            }
+            if (strm->avail_out == 0) {
+                out_cap *= 2;
+                out_buf = (guint8 *)wmem_realloc(wmem_file_scope(), out_buf, out_cap);
+                continue;
             }
+            if (zret == Z_BUF_ERROR) {
+                return NULL; /* Needs more input: truncated/corrupt frame */
+            }
+        } else {
+            return NULL; /* Corrupt deflate data poisons the context */
         }
     }
+
+    cached = wmem_new(wmem_file_scope(), mcp_cached_buf_t);
+    cached->data = out_buf;
+    cached->len = out_len;
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_mcp, MCP_PDATA_INFLATED + ordinal, cached);
+
+    inflated_tvb = tvb_new_child_real_data(payload_tvb, out_buf, out_len, out_len);
+    add_new_data_source(pinfo, inflated_tvb, "Inflated WebSocket payload");
+    return inflated_tvb;
 }
+#endif /* HAVE_ZLIB */
 
-static const char *get_method_description(const char *method) {
-    int i;
-    
-    if (!method) return NULL;
-    
-    /* Check MCP methods */
-    for (i = 0; mcp_methods[i].method; i++) {
-        if (strcmp(method, mcp_methods[i].method) == 0) {
-            return mcp_methods[i].description;
+#ifdef HAVE_GCRYPT
+/* Key material for a session: the UAT row matching the conversation's
+ * agent id, or a wildcard row with an empty agent id */
+static const char *mcp_session_secret(const char *agent_id) {
+    const char *wildcard = NULL;
+    guint i;
+
+    for (i = 0; i < mcp_ratchet_num_keys; i++) {
+        const mcp_ratchet_key_t *rec = &mcp_ratchet_keys[i];
+
+        if (!rec->agent_id || rec->agent_id[0] == '\0') {
+            wildcard = rec->secret;
+        } else if (agent_id && strcmp(rec->agent_id, agent_id) == 0) {
+            return rec->secret;
+        }
+    }
+    return wildcard;
+}
+
+/* Derive the sending-chain key the way both Java sides do:
+ * SHA-256(key material || "send"). Each peer encrypts with its own
+ * sending chain derived from the same material, so one chain key serves
+ * both directions. Runs once per conversation. */
+static gboolean mcp_ratchet_chain_init(mcp_conv_t *conv) {
+    const char *secret = mcp_session_secret(conv->agent_id);
+    gcry_md_hd_t md;
+
+    if (!secret) {
+        conv->no_session_key = TRUE;
+        return FALSE;
+    }
+    if (gcry_md_open(&md, GCRY_MD_SHA256, 0) != 0) {
+        return FALSE;
+    }
+    gcry_md_write(md, secret, strlen(secret));
+    gcry_md_write(md, "send", 4);
+    memcpy(conv->chain_key, gcry_md_read(md, GCRY_MD_SHA256), 32);
+    gcry_md_close(md);
+    conv->chain_ready = TRUE;
+    return TRUE;
+}
+
+/* Pull message_counter out of a ratchet header span. The header is a tiny
+ * flat object, so a plain scan is enough. Returns 0 when absent (real
+ * counters start at 1). */
+static guint32 mcp_ratchet_hdr_counter(const mcp_span_t *hdr) {
+    static const char key[] = "\"message_counter\"";
+    const char *p = hdr->start;
+    const char *end = hdr->start + hdr->len;
+    guint32 counter = 0;
+
+    for (; p + sizeof(key) - 1 < end; p++) {
+        if (*p == '"' && memcmp(p, key, sizeof(key) - 1) == 0) {
+            p += sizeof(key) - 1;
+            while (p < end && (*p == ':' || *p == ' ')) p++;
+            while (p < end && *p >= '0' && *p <= '9') {
+                counter = counter * 10 + (guint32)(*p++ - '0');
+            }
+            break;
         }
     }
-    
-    /* Check chess tools */
-    for (i = 0; chess_tools[i].method; i++) {
-        if (strcmp(method, chess_tools[i].method) == 0) {
-            return chess_tools[i].description;
+    return counter;
+}
+
+/* Decrypt one encrypted envelope into a plaintext tvb, or NULL when no key
+ * is configured or the ciphertext does not authenticate. The chain key and
+ * direction counters are conversation state computed once per session; the
+ * gcry handle is opened once per process and rekeyed per message, since
+ * AES-GCM carries no state between messages. First pass only -- the
+ * fallback counters are order-dependent -- with the plaintext cached in
+ * file-scope proto_data like inflated payloads are. */
+static tvbuff_t *mcp_decrypt_payload(tvbuff_t *payload_tvb, packet_info *pinfo,
+                                     const mcp_json_data_t *d, guint ordinal) {
+    static gcry_cipher_hd_t cipher_hd;
+    mcp_conv_t *conv;
+    mcp_cached_buf_t *cached;
+    guint dir = (pinfo->srcport < pinfo->destport) ? 0 : 1;
+    guint32 counter;
+    guchar *iv, *ct;
+    gsize iv_len, ct_len;
+    guint8 msg_key[32];
+    char counter_str[16];
+    gcry_md_hd_t md;
+    guint8 *plain;
+    guint plain_len;
+    tvbuff_t *plain_tvb;
+
+    if (pinfo->fd->visited) {
+        cached = (mcp_cached_buf_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                                                      MCP_PDATA_DECRYPTED + ordinal);
+        if (!cached) {
+            return NULL;
         }
+        plain_tvb = tvb_new_child_real_data(payload_tvb, cached->data, cached->len, cached->len);
+        add_new_data_source(pinfo, plain_tvb, "Decrypted MCP message");
+        return plain_tvb;
     }
-    
-    /* Check chess resources */
-    for (i = 0; chess_resources[i].method; i++) {
-        if (strcmp(method, chess_resources[i].method) == 0) {
-            return chess_resources[i].description;
+
+    conv = get_mcp_conv(pinfo);
+    /* Count every envelope, key or no key, so the fallback counters stay in
+     * step with the sender's chain if a key is added mid-session */
+    counter = ++conv->ratchet_count[dir];
+    if (d->ratchet_header.len > 0) {
+        guint32 hdr_counter = mcp_ratchet_hdr_counter(&d->ratchet_header);
+        if (hdr_counter > 0) {
+            counter = hdr_counter;
         }
     }
-    
-    return NULL;
+
+    if (conv->no_session_key) {
+        return NULL;
+    }
+    if (!conv->chain_ready && !mcp_ratchet_chain_init(conv)) {
+        return NULL;
+    }
+    if (!cipher_hd &&
+        gcry_cipher_open(&cipher_hd, GCRY_CIPHER_AES256, GCRY_CIPHER_MODE_GCM, 0) != 0) {
+        return NULL;
+    }
+
+    /* Per-message key: SHA-256(chain key || decimal counter) */
+    if (gcry_md_open(&md, GCRY_MD_SHA256, 0) != 0) {
+        return NULL;
+    }
+    gcry_md_write(md, conv->chain_key, 32);
+    gcry_md_write(md, counter_str, (gsize)snprintf(counter_str, sizeof(counter_str), "%u", counter));
+    memcpy(msg_key, gcry_md_read(md, GCRY_MD_SHA256), 32);
+    gcry_md_close(md);
+
+    iv = g_base64_decode(span_strdup(&d->iv), &iv_len);
+    ct = g_base64_decode(span_strdup(&d->ciphertext), &ct_len);
+    if (!iv || !ct || iv_len == 0 || ct_len <= 16) {
+        g_free(iv);
+        g_free(ct);
+        return NULL;
+    }
+
+    /* The GCM tag rides as the last 16 bytes of the ciphertext */
+    plain_len = (guint)(ct_len - 16);
+    plain = (guint8 *)wmem_alloc(wmem_file_scope(), plain_len);
+    if (gcry_cipher_setkey(cipher_hd, msg_key, 32) != 0 ||
+        gcry_cipher_setiv(cipher_hd, iv, iv_len) != 0 ||
+        gcry_cipher_decrypt(cipher_hd, plain, plain_len, ct, plain_len) != 0 ||
+        gcry_cipher_checktag(cipher_hd, ct + plain_len, 16) != 0) {
+        g_free(iv);
+        g_free(ct);
+        return NULL;
+    }
+    g_free(iv);
+    g_free(ct);
+
+    cached = wmem_new(wmem_file_scope(), mcp_cached_buf_t);
+    cached->data = plain;
+    cached->len = plain_len;
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                     MCP_PDATA_DECRYPTED + ordinal, cached);
+
+    plain_tvb = tvb_new_child_real_data(payload_tvb, plain, plain_len, plain_len);
+    add_new_data_source(pinfo, plain_tvb, "Decrypted MCP message");
+    return plain_tvb;
+}
+#endif /* HAVE_GCRYPT */
+
+/* Accumulate one fragment of a FIN=0 fragmented message into the
+ * per-conversation buffer for its direction. The combined payload is parsed
+ * exactly once, when the FIN=1 continuation arrives; intermediate fragments
+ * no longer get a doomed parse_json_rpc run each. The reassembled string is
+ * remembered in file-scope proto_data so GUI re-dissection of the final
+ * frame does not depend on conversation state that has since been reset. */
+static void dissect_mcp_fragment(tvbuff_t *payload_tvb, packet_info *pinfo, proto_tree *ws_tree,
+                                 guint8 opcode, guint8 fin) {
+    mcp_conv_t *conv = get_mcp_conv(pinfo);
+    guint dir = (pinfo->srcport < pinfo->destport) ? 0 : 1;
+    const char *reassembled = NULL;
+    guint ordinal = 0;
+
+    /* Two fragmented messages (one per direction) can complete in the same
+     * segment; key the cache per completing frame, advancing the counter on
+     * both passes so replay hits the same slot */
+    if (fin) {
+        ordinal = mcp_pool_counter_next(pinfo, MCP_PDATA_REASSEMBLED_ORDINAL);
+    }
+
+    if (!pinfo->fd->visited) {
+        wmem_strbuf_t *buf;
+        char *frag = tvb_get_string_enc(wmem_packet_scope(), payload_tvb, 0, -1, ENC_ASCII);
+
+        if (opcode == 1) {
+            /* Initial fragment: start a fresh buffer, dropping any stale one */
+            conv->frag_buf[dir] = wmem_strbuf_new(wmem_file_scope(), NULL);
+        }
+        buf = conv->frag_buf[dir];
+        if (!buf) {
+            return; /* Continuation without a start frame (capture began mid-message) */
+        }
+
+        wmem_strbuf_append(buf, frag);
+        if (fin) {
+            reassembled = wmem_strbuf_get_str(buf);
+            p_add_proto_data(wmem_file_scope(), pinfo, proto_mcp, MCP_PDATA_REASSEMBLED + ordinal,
+                             (void *)reassembled);
+            conv->frag_buf[dir] = NULL;
+        }
+    } else if (fin) {
+        reassembled = (const char *)p_get_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                                                     MCP_PDATA_REASSEMBLED + ordinal);
+    }
+
+    if (reassembled) {
+        /* Expose the reassembled message as its own data source so parsed
+         * spans map to real offsets in it */
+        guint msg_len = (guint)strlen(reassembled);
+        tvbuff_t *msg_tvb = tvb_new_child_real_data(payload_tvb, (const guint8 *)reassembled,
+                                                    msg_len, msg_len);
+        add_new_data_source(pinfo, msg_tvb, "Reassembled MCP message");
+        dissect_mcp_json(msg_tvb, pinfo, ws_tree);
+    } else {
+        col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
+        if (mcp_msgs_in_packet == 0) {
+            col_set_str(pinfo->cinfo, COL_INFO, "MCP message fragment");
+        }
+    }
+}
+
+/* Update the per-agent session stats for one message on the first pass and
+ * return its ordinal within the agent's session; later passes replay the
+ * number cached in per-packet proto_data. */
+static guint32 mcp_account_agent(packet_info *pinfo, const char *agent_id, guint ordinal) {
+    guint32 agent_seq;
+
+    if (!pinfo->fd->visited) {
+        mcp_agent_t *agent = (mcp_agent_t *)wmem_map_lookup(mcp_agents, agent_id);
+        if (!agent) {
+            agent = wmem_new0(wmem_file_scope(), mcp_agent_t);
+            agent->first_frame = pinfo->num;
+            wmem_map_insert(mcp_agents,
+                            wmem_strdup(wmem_file_scope(), agent_id),
+                            agent);
+        }
+        agent->msgs++;
+        agent->last_frame = pinfo->num;
+        agent_seq = agent->msgs;
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                         MCP_PDATA_AGENT_SEQ + ordinal,
+                         GUINT_TO_POINTER(agent_seq));
+    } else {
+        agent_seq = GPOINTER_TO_UINT(p_get_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                                                      MCP_PDATA_AGENT_SEQ + ordinal));
+    }
+    return agent_seq;
+}
+
+/* Dissect one complete JSON-RPC message (a whole text frame or a reassembled
+ * fragmented message) into the MCP subtree */
+/* Compute the parse mask for this pass. The summary fields (version,
+ * method, id, error, encryption, agent id) are always extracted: columns,
+ * request/response correlation and the tap need them on every pass. The
+ * bulky params/result spans are only extracted when something asks --
+ * a visible tree, a display filter or a tap referencing the field. With
+ * "mcp.method == ..." over a large capture this turns full scans of
+ * 100 KB notification bodies into early exits. */
+static guint mcp_wanted_fields(proto_tree *tree) {
+    guint wanted = MCP_WANT_SUMMARY;
+
+    if (!tree) {
+        return wanted;
+    }
+    if (proto_field_is_referenced(tree, hf_mcp_params)) {
+        wanted |= MCP_WANT_PARAMS;
+    }
+    if (proto_field_is_referenced(tree, hf_mcp_result)) {
+        wanted |= MCP_WANT_RESULT;
+    }
+    return wanted;
+}
+
+/* Bounded early-exit method probe for summary mode.
+ *
+ * The packet-list line only needs the method name, which every sender puts
+ * within the first handful of fields, so a column-only pass can stop after
+ * a Boyer-Moore-Horspool scan of the payload head instead of tokenizing
+ * hundreds of KB of params. The probe is deliberately picky -- the match
+ * must look like a key in object position with a plain string value -- and
+ * any doubt (no hit, escapes, responses) falls back to the full parse. */
+#define MCP_PROBE_CAP 512
+
+static const char mcp_probe_pat[] = "\"method\"";
+#define MCP_PROBE_PAT_LEN ((gsize)sizeof(mcp_probe_pat) - 1)
+static guint8 mcp_probe_skip[256];
+
+static void mcp_probe_init(void) {
+    gsize i;
+
+    memset(mcp_probe_skip, MCP_PROBE_PAT_LEN, sizeof(mcp_probe_skip));
+    for (i = 0; i < MCP_PROBE_PAT_LEN - 1; i++) {
+        mcp_probe_skip[(guint8)mcp_probe_pat[i]] = (guint8)(MCP_PROBE_PAT_LEN - 1 - i);
+    }
+}
+
+/* Find the method value span in the payload head, or fail (len 0) */
+static mcp_span_t mcp_probe_method(const char *buf, gsize len) {
+    mcp_span_t method = { NULL, 0 };
+    gsize cap = (len < MCP_PROBE_CAP) ? len : MCP_PROBE_CAP;
+    gsize i;
+
+    if (cap < MCP_PROBE_PAT_LEN + 4 || buf[0] != '{') {
+        return method;
+    }
+    for (i = MCP_PROBE_PAT_LEN - 1; i < cap; i += mcp_probe_skip[(guint8)buf[i]]) {
+        const char *p, *start;
+
+        if (buf[i] != '"' ||
+            memcmp(buf + i - (MCP_PROBE_PAT_LEN - 1), mcp_probe_pat, MCP_PROBE_PAT_LEN) != 0) {
+            continue;
+        }
+        /* Key position: the previous non-space byte opens or continues an
+         * object. Nested objects pass this test too, but no MCP sender puts
+         * a "method" member anywhere except the envelope. */
+        p = buf + i - MCP_PROBE_PAT_LEN;
+        while (p > buf && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p--;
+        if (*p != '{' && *p != ',') {
+            return method; /* Inside a value: let the real parser decide */
+        }
+        p = buf + i + 1;
+        while (p < buf + cap && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+        if (p >= buf + cap || *p != ':') {
+            return method;
+        }
+        p++;
+        while (p < buf + cap && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+        if (p >= buf + cap || *p != '"') {
+            return method;
+        }
+        start = ++p;
+        while (p < buf + cap && *p != '"' && *p != '\\') p++;
+        if (p >= buf + cap || *p != '"') {
+            return method; /* Truncated by the cap, or escaped: full parse */
+        }
+        method.start = start;
+        method.len = (gsize)(p - start);
+        return method;
+    }
+    return method;
+}
+
+/* Serve one message from the probe alone: protocol/info columns and a
+ * minimal tap record. Returns FALSE when the probe cannot answer and the
+ * caller must run the full parse. */
+static gboolean mcp_probe_dissect(const char *payload, gsize payload_len, packet_info *pinfo) {
+    mcp_span_t method = mcp_probe_method(payload, payload_len);
+    mcp_tap_info_t *tap_info;
+
+    if (method.len == 0) {
+        return FALSE;
+    }
+
+    col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
+    if (mcp_msgs_in_packet == 0) {
+        col_add_fstr(pinfo->cinfo, COL_INFO, "MCP %.*s", (int)method.len, method.start);
+    } else {
+        col_append_fstr(pinfo->cinfo, COL_INFO, ", %.*s", (int)method.len, method.start);
+    }
+    mcp_msgs_in_packet++;
+
+    tap_info = wmem_new0(wmem_packet_scope(), mcp_tap_info_t);
+    tap_info->method = span_strdup(&method);
+    tap_info->srt_method = tap_info->method;
+    tap_queue_packet(mcp_tap, pinfo, tap_info);
+    return TRUE;
+}
+
+#define MCP_CACHE_SPANS(OP) \
+    OP(jsonrpc) OP(method) OP(id) OP(params) OP(result) \
+    OP(error_code_span) OP(error_message) OP(agent_id) \
+    OP(ciphertext) OP(iv) OP(ratchet_header)
+
+static void mcp_cache_store(mcp_cached_msg_t *c, const mcp_json_data_t *d, const char *base) {
+#define MCP_STORE_SPAN(f) \
+    c->f.off = d->f.start ? (guint32)(d->f.start - base) : 0; \
+    c->f.len = (guint32)d->f.len;
+    MCP_CACHE_SPANS(MCP_STORE_SPAN)
+#undef MCP_STORE_SPAN
+    c->error_code = d->error_code;
+    c->encrypted = d->encrypted;
+    c->method_str = d->method_str; /* Interned: file scope for any length */
+    c->agent_id_str = d->agent_id_str;
+    c->id_str = d->id_str ? wmem_strdup(wmem_file_scope(), d->id_str) : NULL;
+}
+
+static void mcp_cache_load(const mcp_cached_msg_t *c, mcp_json_data_t *d, const char *base) {
+#define MCP_LOAD_SPAN(f) \
+    d->f.start = c->f.len ? base + c->f.off : NULL; \
+    d->f.len = c->f.len;
+    MCP_CACHE_SPANS(MCP_LOAD_SPAN)
+#undef MCP_LOAD_SPAN
+    d->error_code = c->error_code;
+    d->encrypted = c->encrypted;
+    d->method_str = c->method_str;
+    d->agent_id_str = c->agent_id_str;
+    d->id_str = c->id_str ? wmem_strdup(wmem_packet_scope(), c->id_str) : NULL;
+}
+
+/* Offset of a parsed span within the payload tvb */
+#define MCP_SPAN_OFF(base, sp) ((gint)((sp).start - (base)))
+
+/* Register one span-backed string field over its real byte range, so the
+ * GUI highlights the bytes and display filters evaluate against tvb data
+ * with no per-packet string copy. */
+static proto_item *add_span_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                 const char *base, const mcp_span_t *sp) {
+    return proto_tree_add_item(tree, hfindex, tvb, MCP_SPAN_OFF(base, *sp), (gint)sp->len, ENC_ASCII);
 }
 
-static void extract_agent_id(const char *params, char *agent_id, size_t agent_id_len) {
-    char *pos, *end;
-    
-    if (!params || !agent_id || agent_id_len == 0) return;
-    
-    /* Look for agentId */
-    pos = strstr(params, "\"agentId\"");
-    if (!pos) {
-        pos = strstr(params, "\"agent_id\"");
-    }
-    
-    if (pos) {
-        pos = strchr(pos, ':');
-        if (pos) {
-            pos++;
-            while (*pos == ' ' || *pos == '\t') pos++;
-            if (*pos == '"') {
-                pos++;
-                end = strchr(pos, '"');
-                if (end && (end - pos) < (int)agent_id_len) {
-                    strncpy(agent_id, pos, end - pos);
-                    agent_id[end - pos] = '\0';
+static void dissect_mcp_json(tvbuff_t *payload_tvb, packet_info *pinfo, proto_tree *ws_tree) {
+    mcp_json_data_t json_data = {0};
+    proto_tree *mcp_tree, *encryption_tree;
+    proto_item *ti;
+    guint wanted;
+    gboolean truncated = FALSE;
+    gsize payload_len = tvb_captured_length(payload_tvb);
+    const char *payload;
+    mcp_cached_msg_t *cached;
+    guint ordinal;
+
+    if (payload_len == 0) {
+        return;
+    }
+
+    /* Every invocation consumes one ordinal, so per-message keys line up
+     * across passes regardless of which messages each pass accepts */
+    ordinal = mcp_pool_counter_next(pinfo, MCP_PDATA_MSG_ORDINAL);
+
+    /* Reopen fast path: a column-only pass over a message the sidecar index
+     * covers is served straight from its record, skipping the JSON walk.
+     * Passes that build a tree fall through and parse lazily. */
+    if (mcp_frame_index && !ws_tree) {
+        const mcp_index_rec_t *rec = mcp_index_lookup(pinfo, ordinal);
+        if (rec) {
+            mcp_dissect_from_index(rec, pinfo, ordinal);
+            return;
+        }
+    }
+
+    /* Parse in place over the tvb bytes: read-only, no intermediate copy */
+    payload = (const char *)tvb_get_ptr(payload_tvb, 0, (gint)payload_len);
+
+    /* Summary mode: a column-only pass that the probe can answer skips the
+     * tokenizer entirely; anything it cannot (responses, odd layouts) falls
+     * through to the normal path */
+    if (mcp_summary_mode && !ws_tree &&
+        mcp_probe_dissect(payload, payload_len, pinfo)) {
+        return;
+    }
+
+    /* Extract only what this pass can actually use: the summary set for
+     * columns/correlation, plus whichever heavyweight fields are referenced
+     * by an open tree, a filter or a tap. */
+    wanted = mcp_wanted_fields(ws_tree);
+
+    /* Bound how much of an oversized payload gets tokenized and displayed;
+     * spans stay offsets into the same bytes either way */
+    if (mcp_parse_cap > 0 && payload_len > mcp_parse_cap) {
+        payload_len = mcp_parse_cap;
+        truncated = TRUE;
+    }
+
+    /* Re-dissection is free when the first pass already parsed at least
+     * the fields this pass wants over at least as many bytes; otherwise
+     * parse and (re)fill the cache. The length check keeps a raised (or
+     * disabled) parse cap from being answered with stale truncated spans. */
+    cached = (mcp_cached_msg_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                                                  MCP_PDATA_PARSED + ordinal);
+    if (cached && (wanted & ~cached->wanted) == 0 && cached->parsed_len >= payload_len) {
+        mcp_cache_load(cached, &json_data, payload);
+    } else {
+        if (cached) {
+            /* Re-parse with the union of both masks, so the refreshed entry
+             * really covers everything its mask claims */
+            wanted |= cached->wanted;
+        }
+        parse_json_rpc_buf(payload, payload_len, &json_data, wanted);
+        if (!cached) {
+            cached = wmem_new0(wmem_file_scope(), mcp_cached_msg_t);
+            p_add_proto_data(wmem_file_scope(), pinfo, proto_mcp,
+                             MCP_PDATA_PARSED + ordinal, cached);
+        }
+        mcp_cache_store(cached, &json_data, payload);
+        cached->wanted = wanted;
+        cached->parsed_len = (guint32)payload_len;
+    }
+
+    if (json_data.jsonrpc.len == 3 && memcmp(json_data.jsonrpc.start, "2.0", 3) == 0) {
+        mcp_conv_t *conv = get_mcp_conv(pinfo);
+        const char *req_label = NULL;
+        mcp_req_entry_t *req_entry = NULL;
+        guint32 agent_seq = 0;
+
+        /* Request/response correlation: requests record id -> method in the
+         * conversation map on the first pass; responses (id, no method) look
+         * the label up so they can be tied back to what was called. */
+        if (json_data.id_str) {
+            if (json_data.method_str) {
+                if (!pinfo->fd->visited && !wmem_map_lookup(conv->req_methods, json_data.id_str)) {
+                    mcp_req_entry_t *entry = wmem_new0(wmem_file_scope(), mcp_req_entry_t);
+                    mcp_span_t tool_name;
+
+                    if (strcmp(json_data.method_str, "tools/call") == 0 &&
+                        json_data.params.len == 0 && !(wanted & MCP_WANT_PARAMS)) {
+                        /* The summary parse skipped params; re-read them for
+                         * the tool name (tools/call requests only) */
+                        mcp_json_data_t full = {0};
+                        parse_json_rpc_buf(payload, payload_len, &full, MCP_WANT_PARAMS);
+                        json_data.params = full.params;
+                    }
+                    if (strcmp(json_data.method_str, "tools/call") == 0 &&
+                        json_data.params.len > 0 &&
+                        mcp_find_member_string(&json_data.params, "name", &tool_name)) {
+                        entry->srt_method = span_strdup_scope(wmem_file_scope(), &tool_name);
+                        entry->label = wmem_strdup_printf(wmem_file_scope(), "%s \xe2\x86\x92 %s",
+                                                          json_data.method_str, entry->srt_method);
+                    } else {
+                        entry->srt_method = wmem_strdup(wmem_file_scope(), json_data.method_str);
+                        entry->label = entry->srt_method;
+                    }
+                    entry->req_time = pinfo->abs_ts;
+                    entry->req_frame = pinfo->num;
+                    wmem_map_insert(conv->req_methods,
+                                    wmem_strdup(wmem_file_scope(), json_data.id_str),
+                                    entry);
+                }
+            } else {
+                req_entry = (mcp_req_entry_t *)wmem_map_lookup(conv->req_methods, json_data.id_str);
+                if (req_entry) {
+                    req_label = req_entry->label;
+                } else if (mcp_frame_index) {
+                    /* Correlation map is cold (the request was fast-pathed
+                     * from the index); the record kept the request's method
+                     * slot, so the label survives */
+                    const mcp_index_rec_t *rec = mcp_index_lookup(pinfo, ordinal);
+                    if (rec && (rec->flags & MCP_IDX_RESPONSE) &&
+                        rec->method_slot < MCP_METHOD_HASH_SIZE) {
+                        req_label = mcp_method_table[rec->method_slot].method;
+                    }
+                }
+            }
+        }
+
+        /* Per-agent session accounting: first pass assigns this message its
+         * ordinal in the agent's session and caches it per packet, so later
+         * passes replay the same sequence numbers. */
+        if (json_data.agent_id_str) {
+            agent_seq = mcp_account_agent(pinfo, json_data.agent_id_str, ordinal);
+#ifdef HAVE_GCRYPT
+            /* Remember which agent owns this conversation so encrypted
+             * envelopes (which carry no agent id) can pick their session
+             * key; the interned string is file-scope like the conversation */
+            if (!conv->agent_id) {
+                conv->agent_id = json_data.agent_id_str;
+            }
+#endif
+        }
+
+        /* Create MCP subtree */
+        mcp_tree = proto_tree_add_subtree(ws_tree, payload_tvb, 0, -1, ett_mcp, NULL, "Model Context Protocol");
+
+        if (truncated && ws_tree) {
+            ti = proto_tree_add_boolean(mcp_tree, hf_mcp_params_truncated, payload_tvb, 0, 0, TRUE);
+            proto_item_set_generated(ti);
+            expert_add_info(pinfo, ti, &ei_mcp_payload_truncated);
+        }
+
+        /* Add basic fields over their real byte ranges */
+        add_span_item(mcp_tree, hf_mcp_version, payload_tvb, payload, &json_data.jsonrpc);
+
+        if (json_data.method.len > 0) {
+            const char *method_desc = get_method_description(json_data.method_str);
+            ti = add_span_item(mcp_tree, hf_mcp_method, payload_tvb, payload, &json_data.method);
+            if (method_desc) {
+                proto_item_append_text(ti, " (%s)", method_desc);
+            }
+        }
+
+        if (json_data.id.len > 0) {
+            add_span_item(mcp_tree, hf_mcp_id, payload_tvb, payload, &json_data.id);
+        }
+
+        if (req_label && ws_tree) {
+            ti = proto_tree_add_string(mcp_tree, hf_mcp_request_method, payload_tvb, 0, 0, req_label);
+            proto_item_set_generated(ti);
+        }
+        if (req_entry) {
+            nstime_t rtt;
+            nstime_delta(&rtt, &pinfo->abs_ts, &req_entry->req_time);
+            if (ws_tree) {
+                ti = proto_tree_add_time(mcp_tree, hf_mcp_rtt, payload_tvb, 0, 0, &rtt);
+                proto_item_set_generated(ti);
+            }
+        }
+
+        /* Add encryption fields if present */
+        if (json_data.encrypted) {
+            encryption_tree = proto_tree_add_subtree(mcp_tree, payload_tvb, 0, 0, ett_mcp_encryption, NULL, "Encryption");
+            proto_tree_add_boolean(encryption_tree, hf_mcp_encrypted, payload_tvb, 0, 0, TRUE);
+
+            if (json_data.ciphertext.len > 0) {
+                add_span_item(encryption_tree, hf_mcp_ciphertext, payload_tvb, payload, &json_data.ciphertext);
+            }
+            if (json_data.iv.len > 0) {
+                add_span_item(encryption_tree, hf_mcp_iv, payload_tvb, payload, &json_data.iv);
+            }
+            if (json_data.ratchet_header.len > 0) {
+                add_span_item(encryption_tree, hf_mcp_ratchet_header, payload_tvb, payload, &json_data.ratchet_header);
+            }
+
+#ifdef HAVE_GCRYPT
+            /* With session key material configured, recover the plaintext
+             * and dissect it as its own message: columns, correlation, the
+             * tap and the index all see the inner JSON-RPC instead of the
+             * opaque envelope. The envelope itself neither reaches the
+             * columns nor the tap, so nothing is counted twice. */
+            if (json_data.ciphertext.len > 0 && json_data.iv.len > 0 && !mcp_in_decrypted) {
+                tvbuff_t *plain_tvb = mcp_decrypt_payload(payload_tvb, pinfo, &json_data, ordinal);
+
+                if (plain_tvb) {
+                    ti = proto_tree_add_boolean(encryption_tree, hf_mcp_decrypted, plain_tvb, 0, 0, TRUE);
+                    proto_item_set_generated(ti);
+                    /* The recursive call draws its own dissect ordinal, so
+                     * the plaintext's parse cache cannot collide with the
+                     * envelope's */
+                    mcp_in_decrypted = TRUE;
+                    dissect_mcp_json(plain_tvb, pinfo, ws_tree);
+                    mcp_in_decrypted = FALSE;
+                    free_mcp_data(&json_data);
+                    return;
+                }
+                if (mcp_ratchet_num_keys > 0) {
+                    expert_add_info(pinfo, encryption_tree, &ei_mcp_decrypt_failed);
                 }
             }
+#endif
+        }
+#ifdef HAVE_GCRYPT
+        if (mcp_in_decrypted) {
+            /* Recovered plaintext: the wire still carried ciphertext, so
+             * flag it for the column, the tap and the index */
+            json_data.encrypted = TRUE;
+        }
+#endif
+
+        /* Add params/result/error */
+        if (json_data.params.len > 0) {
+            add_span_item(mcp_tree, hf_mcp_params, payload_tvb, payload, &json_data.params);
+        }
+
+        if (json_data.result.len > 0) {
+            add_span_item(mcp_tree, hf_mcp_result, payload_tvb, payload, &json_data.result);
+        }
+
+        if (json_data.error_code != 0) {
+            proto_tree_add_int(mcp_tree, hf_mcp_error_code, payload_tvb,
+                               MCP_SPAN_OFF(payload, json_data.error_code_span),
+                               (gint)json_data.error_code_span.len, json_data.error_code);
+        }
+
+        if (json_data.error_message.len > 0) {
+            add_span_item(mcp_tree, hf_mcp_error_message, payload_tvb, payload, &json_data.error_message);
+        }
+
+        if (json_data.agent_id.len > 0) {
+            add_span_item(mcp_tree, hf_mcp_agent_id, payload_tvb, payload, &json_data.agent_id);
+            if (agent_seq > 0 && ws_tree) {
+                ti = proto_tree_add_uint(mcp_tree, hf_mcp_agent_msg_seq, payload_tvb, 0, 0, agent_seq);
+                proto_item_set_generated(ti);
+            }
+        }
+
+        /* Set protocol info; later frames in the same packet append
+         * instead of overwriting */
+        col_set_str(pinfo->cinfo, COL_PROTOCOL, "MCP");
+        if (json_data.method_str) {
+            if (mcp_msgs_in_packet == 0) {
+                col_add_fstr(pinfo->cinfo, COL_INFO, "MCP %s", json_data.method_str);
+            } else {
+                col_append_fstr(pinfo->cinfo, COL_INFO, ", %s", json_data.method_str);
+            }
+            if (json_data.encrypted) {
+                col_append_str(pinfo->cinfo, COL_INFO, " (Encrypted)");
+            }
+        } else if (req_label) {
+            if (mcp_msgs_in_packet == 0) {
+                col_add_fstr(pinfo->cinfo, COL_INFO, "MCP Response (%s)", req_label);
+            } else {
+                col_append_fstr(pinfo->cinfo, COL_INFO, ", Response (%s)", req_label);
+            }
+        }
+        mcp_msgs_in_packet++;
+
+        /* Color coding for errors */
+        if (json_data.error_code != 0) {
+            col_append_fstr(pinfo->cinfo, COL_INFO, " [ERROR %d]", json_data.error_code);
+        }
+
+        /* Feed the statistics tap (-z mcp,srt) */
+        {
+            mcp_tap_info_t *tap_info = wmem_new0(wmem_packet_scope(), mcp_tap_info_t);
+
+            if (req_entry) {
+                tap_info->srt_method = req_entry->srt_method;
+                tap_info->is_response = TRUE;
+                tap_info->has_rtt = TRUE;
+                tap_info->req_time = req_entry->req_time;
+            } else {
+                tap_info->srt_method = json_data.method_str
+                    ? wmem_strdup(wmem_packet_scope(), json_data.method_str) : NULL;
+                tap_info->is_response = (json_data.result.len > 0 || json_data.error_code != 0);
+            }
+            tap_info->method = json_data.method_str;
+            tap_info->id = json_data.id_str;
+            tap_info->error_code = json_data.error_code;
+            tap_info->encrypted = json_data.encrypted;
+            tap_info->agent_id = json_data.agent_id_str;
+            tap_queue_packet(mcp_tap, pinfo, tap_info);
         }
+
+        /* Append this message to the sidecar index being built */
+        if (mcp_index_fp && !pinfo->fd->visited) {
+            mcp_index_write(pinfo, &json_data, req_entry, ordinal);
+        }
+    }
+
+    /* Clean up */
+    free_mcp_data(&json_data);
+}
+
+/* The structural scanner and the span tokenizer live in mcp_core.c, shared
+ * with the standalone tools; what remains here is the wmem-side layer:
+ * scoped copies, interning, and the parse wrapper that derives them. */
+
+static char *span_strdup_scope(wmem_allocator_t *scope, const mcp_span_t *span) {
+    return wmem_strndup(scope, span->start, span->len);
+}
+
+static char *span_strdup(const mcp_span_t *span) {
+    return span_strdup_scope(wmem_packet_scope(), span);
+}
+
+static const char *mcp_intern_string(const char *str) {
+    const char *canon = (const char *)wmem_map_lookup(mcp_interned, str);
+
+    if (!canon) {
+        canon = wmem_strdup(wmem_file_scope(), str);
+        wmem_map_insert(mcp_interned, (void *)canon, (void *)canon);
+    }
+    return canon;
+}
+
+/* Interned copy of a span. Values short enough for the stack buffer (every
+ * method and agent id in practice) avoid any allocation on a hit. Oversized
+ * values still go through the map via a temporary copy: the parse cache
+ * keeps these pointers at file scope, so handing out a packet-scope copy
+ * here would dangle on re-dissection. Only parsing outside a capture
+ * context (no map) falls back to packet scope. */
+static const char *mcp_intern_span(const mcp_span_t *span) {
+    char buf[128];
+
+    if (!mcp_interned) {
+        return span_strdup(span);
     }
+    if (span->len >= sizeof(buf)) {
+        return mcp_intern_string(span_strdup(span));
+    }
+    memcpy(buf, span->start, span->len);
+    buf[span->len] = '\0';
+    return mcp_intern_string(buf);
+}
+
+/* Core parse plus the allocator-backed strings the dissector layers on
+ * top: interned method/agent ids (file scope when capturing) and a
+ * packet-scope id copy for the correlation map. */
+static void parse_json_rpc_buf(const char *buf, gsize len, mcp_json_data_t *data, guint wanted) {
+    mcp_parse_json_rpc(buf, len, data, wanted);
+    if (data->method.len > 0) {
+        data->method_str = mcp_intern_span(&data->method);
+    }
+    if (data->id.len > 0) {
+        data->id_str = span_strdup(&data->id);
+    }
+    if (data->agent_id.len > 0) {
+        data->agent_id_str = mcp_intern_span(&data->agent_id);
+    }
+}
+
+/* FNV-1a over the generated seed; the seed/size make every known method
+ * land in its own slot, so lookups cost at most one strcmp */
+static guint32 mcp_method_hash(const char *method) {
+    return mcp_fnv1a(method, MCP_METHOD_HASH_SEED) & (MCP_METHOD_HASH_SIZE - 1);
+}
+
+static const char *get_method_description(const char *method) {
+    const mcp_method_t *entry;
+
+    if (!method) return NULL;
+
+    entry = &mcp_method_table[mcp_method_hash(method)];
+    if (entry->method && strcmp(method, entry->method) == 0) {
+        return entry->description;
+    }
+    return NULL;
 }
 
 static void free_mcp_data(mcp_json_data_t *data) {
@@ -38,11 +38,12 @@ mcp_websocket_protocol.fields = {
     f_ws_opcode, f_ws_fin, f_ws_payload_length, f_ws_payload
 }
 
+-- BEGIN GENERATED METHOD TABLES (gen_mcp_methods.py, edit mcp_methods.txt)
 -- MCP method constants
 local MCP_METHODS = {
     ["initialize"] = "Initialize MCP connection",
     ["tools/list"] = "List available tools",
-    ["resources/list"] = "List available resources", 
+    ["resources/list"] = "List available resources",
     ["tools/call"] = "Call a tool",
     ["resources/read"] = "Read a resource",
     ["notifications/initialized"] = "Connection initialized notification",
@@ -71,6 +72,7 @@ local CHESS_RESOURCES = {
     ["chess://training-data"] = "Training data",
     ["chess://performance-metrics"] = "Performance metrics"
 }
+-- END GENERATED METHOD TABLES
 
 -- AI systems
 local AI_SYSTEMS = {
@@ -0,0 +1,31 @@
+/* Generated by gen_mcp_methods.py from mcp_methods.txt — do not edit.
+ * Collision-free FNV-1a hash table over all MCP methods, tools and
+ * resources: lookup is one hash and at most one strcmp. */
+
+#define MCP_METHOD_HASH_SIZE 128
+#define MCP_METHOD_HASH_SEED 0x0000000du
+
+static const mcp_method_t mcp_method_table[MCP_METHOD_HASH_SIZE] = {
+    [11] = {"notifications/chess/training_progress", "Training progress notification"},
+    [12] = {"get_legal_moves", "Get legal moves"},
+    [14] = {"notifications/initialized", "Connection initialized notification"},
+    [25] = {"create_tournament", "Create tournament"},
+    [35] = {"chess://opening-book", "Opening book database"},
+    [44] = {"chess://ai-systems", "AI systems information"},
+    [45] = {"notifications/chess/game_state", "Chess game state notification"},
+    [51] = {"get_move_hint", "Get move hint"},
+    [53] = {"tools/call", "Call a tool"},
+    [54] = {"chess://game-history", "Game history"},
+    [57] = {"create_chess_game", "Create new chess game"},
+    [61] = {"chess://performance-metrics", "Performance metrics"},
+    [62] = {"get_board_state", "Get current board state"},
+    [78] = {"chess://training-data", "Training data"},
+    [93] = {"tools/list", "List available tools"},
+    [99] = {"initialize", "Initialize MCP connection"},
+    [109] = {"notifications/chess/ai_move", "AI move notification"},
+    [115] = {"resources/read", "Read a resource"},
+    [116] = {"make_chess_move", "Make a chess move"},
+    [119] = {"resources/list", "List available resources"},
+    [126] = {"get_tournament_status", "Get tournament status"},
+    [127] = {"analyze_position", "Analyze chess position"},
+};
@@ -0,0 +1,653 @@
+/*
+ * mcpgrep: standalone multithreaded MCP capture analyzer.
+ *
+ * tshark dissects single-threaded, so batch analysis of large captures pegs
+ * one core. mcpgrep mmaps a pcap/pcapng file, partitions the packets by TCP
+ * stream, and walks the streams across a worker pool using the same parse
+ * core (mcp_core.c) as the Wireshark plugin, emitting the per-method stats
+ * and NDJSON lines the plugin's tap produces.
+ *
+ * Scope, by design:
+ *   - IPv4 TCP only, segments assumed in capture order (no resequencing)
+ *   - permessage-deflate streams are counted but not inflated
+ *
+ * Usage: mcpgrep [-j threads] [-p port] [-m method] [-a agent]
+ *                [-o out.ndjson] capture.pcap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mcp_core.h"
+
+/* Generated perfect-hash table, same manifest as the dissector */
+typedef struct {
+    const char *method;
+    const char *description;
+} mcp_method_t;
+#include "mcp_methods.h"
+
+#define DEFAULT_PORT 8082
+
+/* ---------------- capture file iteration ---------------- */
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t caplen;
+    uint32_t frame;
+    uint64_t ts_usec;
+    int linktype;
+} raw_pkt_t;
+
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    size_t off;
+    uint32_t frame;
+    int swapped;
+    int nsec;           /* pcap: nanosecond timestamp magic */
+    int is_pcapng;
+    int linktype;       /* pcap global header / pcapng IDBs (first wins) */
+} cap_reader_t;
+
+static uint32_t rd32(const cap_reader_t *r, const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return r->swapped ? __builtin_bswap32(v) : v;
+}
+
+static uint16_t rd16(const cap_reader_t *r, const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return r->swapped ? __builtin_bswap16(v) : v;
+}
+
+static int cap_open(cap_reader_t *r, const uint8_t *base, size_t size) {
+    uint32_t magic;
+
+    memset(r, 0, sizeof(*r));
+    r->base = base;
+    r->size = size;
+    if (size < 24) return -1;
+    memcpy(&magic, base, 4);
+
+    if (magic == 0x0A0D0D0A) {
+        uint32_t bom;
+        memcpy(&bom, base + 8, 4);
+        if (bom != 0x1A2B3C4D && bom != 0x4D3C2B1A) return -1;
+        r->is_pcapng = 1;
+        r->swapped = (bom == 0x4D3C2B1A);
+        r->linktype = -1;
+        r->off = 0;
+        return 0;
+    }
+
+    switch (magic) {
+        case 0xA1B2C3D4: break;
+        case 0xD4C3B2A1: r->swapped = 1; break;
+        case 0xA1B23C4D: r->nsec = 1; break;
+        case 0x4D3CB2A1: r->swapped = 1; r->nsec = 1; break;
+        default: return -1;
+    }
+    r->linktype = (int)rd32(r, base + 20);
+    r->off = 24;
+    return 0;
+}
+
+/* Return 1 and fill 'pkt' for the next packet, 0 at end of file */
+static int cap_next(cap_reader_t *r, raw_pkt_t *pkt) {
+    if (!r->is_pcapng) {
+        uint32_t ts_sec, ts_frac, caplen;
+
+        if (r->off + 16 > r->size) return 0;
+        ts_sec = rd32(r, r->base + r->off);
+        ts_frac = rd32(r, r->base + r->off + 4);
+        caplen = rd32(r, r->base + r->off + 8);
+        r->off += 16;
+        if (caplen > r->size - r->off) return 0;
+        pkt->data = r->base + r->off;
+        pkt->caplen = caplen;
+        pkt->ts_usec = (uint64_t)ts_sec * 1000000u + (r->nsec ? ts_frac / 1000 : ts_frac);
+        pkt->linktype = r->linktype;
+        pkt->frame = ++r->frame;
+        r->off += caplen;
+        return 1;
+    }
+
+    while (r->off + 12 <= r->size) {
+        uint32_t type = rd32(r, r->base + r->off);
+        uint32_t blen = rd32(r, r->base + r->off + 4);
+        const uint8_t *body = r->base + r->off + 8;
+
+        if (blen < 12 || blen > r->size - r->off) return 0;
+        if (type == 0x00000001 && blen >= 20) {
+            /* IDB: first interface's linktype applies (single-NIC captures) */
+            if (r->linktype < 0) r->linktype = rd16(r, body);
+        } else if (type == 0x00000006 && blen >= 32) {
+            /* EPB: assume the default microsecond if_tsresol */
+            uint32_t ts_hi = rd32(r, body + 4);
+            uint32_t ts_lo = rd32(r, body + 8);
+            uint32_t caplen = rd32(r, body + 12);
+
+            if (caplen <= blen - 32) {
+                pkt->data = body + 20;
+                pkt->caplen = caplen;
+                pkt->ts_usec = ((uint64_t)ts_hi << 32) | ts_lo;
+                pkt->linktype = r->linktype;
+                pkt->frame = ++r->frame;
+                r->off += blen;
+                return 1;
+            }
+        }
+        r->off += blen;
+    }
+    return 0;
+}
+
+/* ---------------- link/IP/TCP decapsulation ---------------- */
+
+typedef struct {
+    uint32_t src_ip, dst_ip;
+    uint16_t src_port, dst_port;
+    const uint8_t *payload;
+    uint32_t payload_len;
+} tcp_seg_t;
+
+/* Strip the link, IP and TCP headers; network byte order throughout,
+ * independent of the capture's own endianness. Returns 1 on a TCP segment
+ * with payload. */
+static int decap_tcp(const raw_pkt_t *pkt, tcp_seg_t *seg) {
+    const uint8_t *p = pkt->data;
+    uint32_t len = pkt->caplen;
+    uint32_t ip_hl, tcp_hl, ip_total;
+    uint16_t ethertype;
+
+    switch (pkt->linktype) {
+        case 1:   /* EN10MB */
+            if (len < 14) return 0;
+            ethertype = (uint16_t)((p[12] << 8) | p[13]);
+            p += 14; len -= 14;
+            if (ethertype == 0x8100) { /* 802.1Q */
+                if (len < 4) return 0;
+                ethertype = (uint16_t)((p[2] << 8) | p[3]);
+                p += 4; len -= 4;
+            }
+            if (ethertype != 0x0800) return 0;
+            break;
+        case 101: /* RAW: IP directly */
+            break;
+        case 113: /* LINUX_SLL */
+            if (len < 16) return 0;
+            ethertype = (uint16_t)((p[14] << 8) | p[15]);
+            if (ethertype != 0x0800) return 0;
+            p += 16; len -= 16;
+            break;
+        case 0:   /* NULL/loopback: 4-byte family in host order */
+            if (len < 4) return 0;
+            p += 4; len -= 4;
+            break;
+        default:
+            return 0;
+    }
+
+    if (len < 20 || (p[0] >> 4) != 4) return 0;
+    ip_hl = (uint32_t)(p[0] & 0x0F) * 4;
+    ip_total = (uint32_t)((p[2] << 8) | p[3]);
+    if (p[9] != 6 || len < ip_hl + 20) return 0;
+    if (ip_total > len) ip_total = len;
+    /* A total length smaller than the headers (a corrupt or crafted packet)
+     * would underflow the payload arithmetic below */
+    if (ip_total < ip_hl + 20) return 0;
+
+    memcpy(&seg->src_ip, p + 12, 4);
+    memcpy(&seg->dst_ip, p + 16, 4);
+    p += ip_hl; len = ip_total - ip_hl;
+
+    seg->src_port = (uint16_t)((p[0] << 8) | p[1]);
+    seg->dst_port = (uint16_t)((p[2] << 8) | p[3]);
+    tcp_hl = (uint32_t)(p[12] >> 4) * 4;
+    if (len < tcp_hl) return 0;
+    seg->payload = p + tcp_hl;
+    seg->payload_len = len - tcp_hl;
+    return seg->payload_len > 0;
+}
+
+/* ---------------- per-stream assembly ---------------- */
+
+/* One direction of a stream: the concatenated payload bytes plus segment
+ * marks so every parsed message can be attributed back to its frame */
+typedef struct {
+    uint8_t *buf;
+    size_t len, cap;
+    struct seg_mark { size_t off; uint32_t frame; uint64_t ts_usec; } *marks;
+    size_t n_marks, cap_marks;
+} dir_buf_t;
+
+typedef struct stream {
+    uint32_t ip_a, ip_b;
+    uint16_t port_a, port_b;
+    dir_buf_t dir[2];       /* 0 = a->b, 1 = b->a */
+    size_t total_bytes;
+    struct stream *next;
+} stream_t;
+
+#define STREAM_BUCKETS 4096
+
+static stream_t *stream_tab[STREAM_BUCKETS];
+static stream_t **stream_list;
+static size_t n_streams;
+
+static void dir_append(dir_buf_t *d, const uint8_t *data, size_t len,
+                       uint32_t frame, uint64_t ts_usec) {
+    if (d->len + len > d->cap) {
+        d->cap = d->cap ? d->cap * 2 : 4096;
+        while (d->cap < d->len + len) d->cap *= 2;
+        d->buf = realloc(d->buf, d->cap);
+        if (!d->buf) { perror("realloc"); exit(1); }
+    }
+    if (d->n_marks == d->cap_marks) {
+        d->cap_marks = d->cap_marks ? d->cap_marks * 2 : 64;
+        d->marks = realloc(d->marks, d->cap_marks * sizeof(*d->marks));
+        if (!d->marks) { perror("realloc"); exit(1); }
+    }
+    d->marks[d->n_marks].off = d->len;
+    d->marks[d->n_marks].frame = frame;
+    d->marks[d->n_marks].ts_usec = ts_usec;
+    d->n_marks++;
+    memcpy(d->buf + d->len, data, len);
+    d->len += len;
+}
+
+static const struct seg_mark *dir_mark_at(const dir_buf_t *d, size_t off) {
+    size_t lo = 0, hi = d->n_marks;
+
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (d->marks[mid].off <= off) lo = mid; else hi = mid;
+    }
+    return d->n_marks ? &d->marks[lo] : NULL;
+}
+
+static stream_t *stream_get(const tcp_seg_t *seg, int *dir) {
+    uint32_t ip_a = seg->src_ip, ip_b = seg->dst_ip;
+    uint16_t port_a = seg->src_port, port_b = seg->dst_port;
+    int flipped = 0;
+    uint32_t h;
+    stream_t *st;
+
+    /* Canonical orientation so both directions hash to one stream */
+    if (ip_a > ip_b || (ip_a == ip_b && port_a > port_b)) {
+        uint32_t tip = ip_a; uint16_t tport = port_a;
+        ip_a = ip_b; port_a = port_b;
+        ip_b = tip; port_b = tport;
+        flipped = 1;
+    }
+    h = (ip_a ^ ip_b ^ ((uint32_t)port_a << 16) ^ port_b) & (STREAM_BUCKETS - 1);
+
+    for (st = stream_tab[h]; st; st = st->next) {
+        if (st->ip_a == ip_a && st->ip_b == ip_b &&
+            st->port_a == port_a && st->port_b == port_b) {
+            *dir = flipped;
+            return st;
+        }
+    }
+    st = calloc(1, sizeof(*st));
+    if (!st) { perror("calloc"); exit(1); }
+    st->ip_a = ip_a; st->ip_b = ip_b;
+    st->port_a = port_a; st->port_b = port_b;
+    st->next = stream_tab[h];
+    stream_tab[h] = st;
+    n_streams++;
+    *dir = flipped;
+    return st;
+}
+
+/* ---------------- per-worker analysis ---------------- */
+
+typedef struct {
+    uint64_t messages;
+    uint64_t responses;
+    uint64_t errors;
+    uint64_t encrypted;
+    uint64_t compressed_skipped;
+    uint64_t malformed;
+    uint64_t bytes;
+    uint64_t method_count[MCP_METHOD_HASH_SIZE];
+    uint64_t method_other;
+    char *out;          /* NDJSON lines, merged after join */
+    size_t out_len, out_cap;
+} worker_stats_t;
+
+static const char *opt_method;  /* -m: only this method */
+static const char *opt_agent;   /* -a: only this agent id */
+static FILE *out_fp;
+
+static void out_append(worker_stats_t *ws, const char *line, size_t len) {
+    if (ws->out_len + len > ws->out_cap) {
+        ws->out_cap = ws->out_cap ? ws->out_cap * 2 : 65536;
+        while (ws->out_cap < ws->out_len + len) ws->out_cap *= 2;
+        ws->out = realloc(ws->out, ws->out_cap);
+        if (!ws->out) { perror("realloc"); exit(1); }
+    }
+    memcpy(ws->out + ws->out_len, line, len);
+    ws->out_len += len;
+}
+
+static int span_equals(const mcp_span_t *sp, const char *str) {
+    size_t n = strlen(str);
+    return sp->len == n && memcmp(sp->start, str, n) == 0;
+}
+
+/* Analyze one complete JSON-RPC message */
+static void handle_message(worker_stats_t *ws, const char *buf, size_t len,
+                           uint32_t frame, uint64_t ts_usec) {
+    mcp_json_data_t d;
+    char method[128], agent[64], id[64];
+    int is_response;
+
+    memset(&d, 0, sizeof(d));
+    mcp_parse_json_rpc(buf, len, &d, MCP_WANT_SUMMARY);
+    if (!(d.jsonrpc.len == 3 && memcmp(d.jsonrpc.start, "2.0", 3) == 0)) {
+        return;
+    }
+
+    if (opt_method && !span_equals(&d.method, opt_method)) return;
+    if (opt_agent && !span_equals(&d.agent_id, opt_agent)) return;
+
+    ws->messages++;
+    ws->bytes += len;
+    is_response = (d.method.len == 0);
+    if (is_response) ws->responses++;
+    if (d.error_code != 0) ws->errors++;
+    if (d.encrypted) ws->encrypted++;
+
+    if (d.method.len > 0 && d.method.len < sizeof(method)) {
+        uint32_t slot;
+        memcpy(method, d.method.start, d.method.len);
+        method[d.method.len] = '\0';
+        slot = mcp_fnv1a(method, MCP_METHOD_HASH_SEED) & (MCP_METHOD_HASH_SIZE - 1);
+        if (mcp_method_table[slot].method && strcmp(method, mcp_method_table[slot].method) == 0) {
+            ws->method_count[slot]++;
+        } else {
+            ws->method_other++;
+        }
+    }
+
+    if (out_fp) {
+        char line[512];
+        int n = snprintf(line, sizeof(line), "{\"frame\":%u,\"time\":%llu.%06llu",
+                         frame, (unsigned long long)(ts_usec / 1000000u),
+                         (unsigned long long)(ts_usec % 1000000u));
+        if (d.method.len > 0 && d.method.len < sizeof(method)) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"method\":\"%.*s\"",
+                          (int)d.method.len, d.method.start);
+        }
+        if (d.id.len > 0 && d.id.len < sizeof(id)) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"id\":\"%.*s\"",
+                          (int)d.id.len, d.id.start);
+        }
+        if (d.agent_id.len > 0 && d.agent_id.len < sizeof(agent)) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"agent_id\":\"%.*s\"",
+                          (int)d.agent_id.len, d.agent_id.start);
+        }
+        if (is_response) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"response\":true");
+        }
+        if (d.error_code != 0) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"error_code\":%d", d.error_code);
+        }
+        if (d.encrypted) {
+            n += snprintf(line + n, sizeof(line) - n, ",\"encrypted\":true");
+        }
+        if (n < (int)sizeof(line) - 2) {
+            line[n++] = '}';
+            line[n++] = '\n';
+            out_append(ws, line, (size_t)n);
+        }
+    }
+}
+
+/* Walk the WebSocket frames of one direction buffer, mirroring the
+ * dissector's frame walk: text frames parse, fragmented messages accumulate
+ * until FIN, implausible headers resync forward one byte at a time. */
+static void analyze_direction(worker_stats_t *ws, const dir_buf_t *d) {
+    size_t off = 0;
+    uint8_t *frag = NULL;
+    size_t frag_len = 0, frag_cap = 0;
+    int frag_active = 0;
+
+    while (off < d->len) {
+        mcp_ws_hdr_t hdr;
+        int rc = mcp_ws_parse_header(d->buf + off, d->len - off, &hdr);
+        uint8_t *payload;
+        uint64_t plen;
+        const struct seg_mark *mark;
+
+        if (rc == MCP_WS_HDR_MORE) break;
+        if (rc == MCP_WS_HDR_MALFORMED) {
+            ws->malformed++;
+            off++;
+            continue;
+        }
+
+        plen = hdr.payload_len;
+        if (plen > d->len - off - hdr.header_len) {
+            break; /* Truncated capture tail */
+        }
+        payload = d->buf + off + hdr.header_len;
+        if (hdr.masked) {
+            mcp_ws_unmask(payload, (size_t)plen, hdr.mask_key);
+        }
+        mark = dir_mark_at(d, off);
+
+        if (hdr.rsv1) {
+            ws->compressed_skipped++;
+        } else if (hdr.opcode == 1 && hdr.fin && !frag_active) {
+            handle_message(ws, (const char *)payload, (size_t)plen,
+                           mark ? mark->frame : 0, mark ? mark->ts_usec : 0);
+        } else if (hdr.opcode == 1 || (hdr.opcode == 0 && frag_active)) {
+            /* Fragmented message: accumulate until FIN */
+            if (hdr.opcode == 1) frag_len = 0;
+            frag_active = 1;
+            if (frag_len + plen > frag_cap) {
+                frag_cap = frag_cap ? frag_cap * 2 : 8192;
+                while (frag_cap < frag_len + plen) frag_cap *= 2;
+                frag = realloc(frag, frag_cap);
+                if (!frag) { perror("realloc"); exit(1); }
+            }
+            memcpy(frag + frag_len, payload, (size_t)plen);
+            frag_len += (size_t)plen;
+            if (hdr.fin) {
+                handle_message(ws, (const char *)frag, frag_len,
+                               mark ? mark->frame : 0, mark ? mark->ts_usec : 0);
+                frag_active = 0;
+            }
+        }
+        off += hdr.header_len + (size_t)plen;
+    }
+    free(frag);
+}
+
+/* Dynamic scheduling: streams sorted largest-first, workers pull the next
+ * unclaimed one, so a few huge streams don't serialize the tail */
+static pthread_mutex_t sched_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t next_stream;
+
+static void *worker_main(void *arg) {
+    worker_stats_t *ws = (worker_stats_t *)arg;
+
+    for (;;) {
+        stream_t *st;
+        size_t idx;
+
+        pthread_mutex_lock(&sched_lock);
+        idx = next_stream++;
+        pthread_mutex_unlock(&sched_lock);
+        if (idx >= n_streams) break;
+
+        st = stream_list[idx];
+        analyze_direction(ws, &st->dir[0]);
+        analyze_direction(ws, &st->dir[1]);
+    }
+    return NULL;
+}
+
+static int stream_cmp_bytes(const void *a, const void *b) {
+    const stream_t *sa = *(stream_t *const *)a;
+    const stream_t *sb = *(stream_t *const *)b;
+
+    if (sa->total_bytes != sb->total_bytes) {
+        return sa->total_bytes < sb->total_bytes ? 1 : -1;
+    }
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: mcpgrep [-j threads] [-p port] [-m method] [-a agent]\n"
+            "               [-o out.ndjson] capture.pcap\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    int opt, fd;
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int port = DEFAULT_PORT;
+    const char *out_path = NULL;
+    struct stat sb;
+    const uint8_t *base;
+    cap_reader_t rd;
+    raw_pkt_t pkt;
+    pthread_t *threads;
+    worker_stats_t *stats, total;
+    size_t i;
+    uint32_t slot;
+    stream_t *st;
+
+    while ((opt = getopt(argc, argv, "j:p:m:a:o:")) != -1) {
+        switch (opt) {
+            case 'j': n_threads = atol(optarg); break;
+            case 'p': port = atoi(optarg); break;
+            case 'm': opt_method = optarg; break;
+            case 'a': opt_agent = optarg; break;
+            case 'o': out_path = optarg; break;
+            default: usage();
+        }
+    }
+    if (optind != argc - 1 || n_threads < 1 || port <= 0 || port > 65535) {
+        usage();
+    }
+
+    fd = open(argv[optind], O_RDONLY);
+    if (fd < 0 || fstat(fd, &sb) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    base = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    if (cap_open(&rd, base, (size_t)sb.st_size) < 0) {
+        fprintf(stderr, "mcpgrep: %s: not a pcap/pcapng file\n", argv[optind]);
+        return 1;
+    }
+
+    /* Sequential partition pass: cheap header decap only, no JSON */
+    while (cap_next(&rd, &pkt)) {
+        tcp_seg_t seg;
+        int dir;
+
+        if (!decap_tcp(&pkt, &seg)) continue;
+        if (seg.src_port != port && seg.dst_port != port) continue;
+        st = stream_get(&seg, &dir);
+        dir_append(&st->dir[dir], seg.payload, seg.payload_len, pkt.frame, pkt.ts_usec);
+        st->total_bytes += seg.payload_len;
+    }
+
+    stream_list = malloc(n_streams * sizeof(*stream_list));
+    if (!stream_list && n_streams) { perror("malloc"); return 1; }
+    for (i = 0, slot = 0; slot < STREAM_BUCKETS; slot++) {
+        for (st = stream_tab[slot]; st; st = st->next) {
+            stream_list[i++] = st;
+        }
+    }
+    qsort(stream_list, n_streams, sizeof(*stream_list), stream_cmp_bytes);
+
+    if (out_path) {
+        out_fp = fopen(out_path, "w");
+        if (!out_fp) {
+            perror(out_path);
+            return 1;
+        }
+    }
+
+    mcp_scan_select_impl();
+
+    if ((size_t)n_threads > n_streams && n_streams > 0) {
+        n_threads = (long)n_streams;
+    }
+    threads = calloc((size_t)n_threads, sizeof(*threads));
+    stats = calloc((size_t)n_threads, sizeof(*stats));
+    if (!threads || !stats) { perror("calloc"); return 1; }
+
+    for (i = 0; i < (size_t)n_threads; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, &stats[i]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i < (size_t)n_threads; i++) {
+        pthread_join(threads[i], NULL);
+        total.messages += stats[i].messages;
+        total.responses += stats[i].responses;
+        total.errors += stats[i].errors;
+        total.encrypted += stats[i].encrypted;
+        total.compressed_skipped += stats[i].compressed_skipped;
+        total.malformed += stats[i].malformed;
+        total.bytes += stats[i].bytes;
+        total.method_other += stats[i].method_other;
+        for (slot = 0; slot < MCP_METHOD_HASH_SIZE; slot++) {
+            total.method_count[slot] += stats[i].method_count[slot];
+        }
+        if (out_fp && stats[i].out_len) {
+            fwrite(stats[i].out, 1, stats[i].out_len, out_fp);
+        }
+        free(stats[i].out);
+    }
+    if (out_fp) {
+        fclose(out_fp);
+    }
+
+    printf("streams: %zu   messages: %llu (%llu responses, %llu errors, %llu encrypted)\n",
+           n_streams, (unsigned long long)total.messages,
+           (unsigned long long)total.responses, (unsigned long long)total.errors,
+           (unsigned long long)total.encrypted);
+    printf("payload bytes parsed: %llu\n", (unsigned long long)total.bytes);
+    if (total.compressed_skipped || total.malformed) {
+        printf("skipped: %llu compressed frames, %llu malformed resyncs\n",
+               (unsigned long long)total.compressed_skipped,
+               (unsigned long long)total.malformed);
+    }
+    printf("methods:\n");
+    for (slot = 0; slot < MCP_METHOD_HASH_SIZE; slot++) {
+        if (total.method_count[slot]) {
+            printf("  %-32s %llu\n", mcp_method_table[slot].method,
+                   (unsigned long long)total.method_count[slot]);
+        }
+    }
+    if (total.method_other) {
+        printf("  %-32s %llu\n", "(not in method table)",
+               (unsigned long long)total.method_other);
+    }
+    return 0;
+}